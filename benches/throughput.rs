@@ -0,0 +1,288 @@
+//! Serialization and deserialization throughput benchmarks.
+//!
+//! Every message shape is serialized through each storage flavor (and COBS on top of
+//! `Slice`), then deserialized with each of the `from_bytes` family of functions.
+//! Per-shape groups report bytes/s, the `batch` group reports messages/s.
+//!
+//! Run with `cargo bench --all-features`.
+
+use criterion::{black_box, criterion_group, criterion_main, BatchSize, Criterion, Throughput};
+use postcard::{
+    from_bytes, from_bytes_cobs, from_bytes_trusted, iter_from_bytes, take_from_bytes, to_allocvec,
+    to_extend, to_slice, to_slice_cobs, to_stdvec, to_stdvec_cobs, to_vec, FixedLayout,
+};
+use serde::{Deserialize, Serialize};
+use std::collections::BTreeMap;
+
+/// Size of the `Slice` and `HVec` buffers, large enough for every shape below
+const BUF_SIZE: usize = 8192;
+
+/// Number of messages serialized or deserialized per iteration of the `batch` group
+const BATCH_LEN: usize = 1000;
+
+#[derive(Serialize, Deserialize, Debug, Clone, PartialEq)]
+struct Telemetry {
+    seq: u32,
+    timestamp_us: u64,
+    node: u8,
+    flags: u16,
+    temperature: f32,
+    accel: [f32; 3],
+    battery_mv: u16,
+    fault: Option<u16>,
+    armed: bool,
+}
+
+#[derive(FixedLayout, Serialize, Deserialize, Debug, Clone, Copy, Default, PartialEq)]
+struct Axes {
+    x: f32,
+    y: f32,
+    z: f32,
+}
+
+/// A long run of fixed-width fields, benchmarked both field by field and as a whole
+#[derive(FixedLayout, Serialize, Deserialize, Debug, PartialEq)]
+struct Imu {
+    seq: u32,
+    timestamp_us: u64,
+    accel: Axes,
+    gyro: Axes,
+    mag: Axes,
+    quat: [f32; 4],
+    temperature: i16,
+    pressure_pa: u32,
+    raw: [u16; 9],
+    status: u8,
+    calibrated: bool,
+}
+
+#[derive(Serialize, Deserialize, Debug, PartialEq)]
+struct FixedImu(#[serde(with = "postcard::fixed")] Imu);
+
+#[derive(Serialize, Deserialize, Debug, PartialEq)]
+struct Payload<'a> {
+    id: u32,
+    bytes: &'a [u8],
+}
+
+#[derive(Serialize, Deserialize, Debug, PartialEq)]
+enum Expr {
+    Lit(i64),
+    Var { id: u16 },
+    Neg(Box<Expr>),
+    Add(Box<Expr>, Box<Expr>),
+}
+
+#[derive(Serialize, Deserialize, Debug, PartialEq)]
+struct Lookup {
+    entries: BTreeMap<u32, f32>,
+}
+
+#[derive(Serialize, Deserialize, Debug, PartialEq)]
+struct LogRecord<'a> {
+    level: u8,
+    target: &'a str,
+    message: &'a str,
+    tags: Vec<&'a str>,
+}
+
+fn telemetry(seq: u32) -> Telemetry {
+    Telemetry {
+        seq,
+        timestamp_us: 1_600_000_000_000_000 + u64::from(seq) * 1_000,
+        node: (seq % 16) as u8,
+        flags: 0x0A05,
+        temperature: 21.5,
+        accel: [0.01, -0.02, 9.81],
+        battery_mv: 3_700,
+        fault: if seq % 8 == 0 { Some(0x0042) } else { None },
+        armed: seq % 2 == 0,
+    }
+}
+
+fn imu(seq: u32) -> Imu {
+    let axes = |v: f32| Axes {
+        x: v,
+        y: -v,
+        z: v * 2.0,
+    };
+    Imu {
+        seq,
+        timestamp_us: 1_600_000_000_000_000 + u64::from(seq) * 1_000,
+        accel: axes(0.01),
+        gyro: axes(0.5),
+        mag: axes(42.0),
+        quat: [1.0, 0.0, 0.0, 0.0],
+        temperature: -12,
+        pressure_pa: 101_325,
+        raw: [0x0102; 9],
+        status: 3,
+        calibrated: true,
+    }
+}
+
+fn expr(depth: u32) -> Expr {
+    match depth {
+        0 => Expr::Lit(-1_234_567),
+        d if d % 3 == 0 => Expr::Neg(Box::new(expr(d - 1))),
+        d if d % 5 == 0 => Expr::Add(Box::new(Expr::Var { id: d as u16 }), Box::new(expr(d - 1))),
+        d => Expr::Add(Box::new(expr(d - 1)), Box::new(Expr::Lit(i64::from(d)))),
+    }
+}
+
+fn lookup() -> Lookup {
+    Lookup {
+        entries: (0..256u32).map(|i| (i * 37, i as f32 * 0.5)).collect(),
+    }
+}
+
+/// Benchmark one message shape across all flavors and deserialization entry points.
+///
+/// This is a macro rather than a generic function so that shapes which borrow from
+/// the input buffer (`&[u8]`, `&str`) can be deserialized with their natural lifetimes.
+macro_rules! bench_shape {
+    ($c:expr, $name:expr, $ty:ty, $value:expr) => {{
+        let value: $ty = $value;
+        let plain = to_stdvec(&value).unwrap();
+        let cobs = to_stdvec_cobs(&value).unwrap();
+
+        let mut group = $c.benchmark_group($name);
+        group.throughput(Throughput::Bytes(plain.len() as u64));
+
+        group.bench_function("ser/Slice", |b| {
+            let mut buf = [0u8; BUF_SIZE];
+            b.iter(|| to_slice(black_box(&value), &mut buf).unwrap().len())
+        });
+        group.bench_function("ser/HVec", |b| {
+            b.iter(|| to_vec::<_, BUF_SIZE>(black_box(&value)).unwrap().len())
+        });
+        group.bench_function("ser/StdVec", |b| {
+            b.iter(|| to_stdvec(black_box(&value)).unwrap().len())
+        });
+        group.bench_function("ser/AllocVec", |b| {
+            b.iter(|| to_allocvec(black_box(&value)).unwrap().len())
+        });
+        group.bench_function("ser/ExtendVec", |b| {
+            let mut buf = Vec::with_capacity(BUF_SIZE);
+            b.iter(|| {
+                buf.clear();
+                to_extend(black_box(&value), &mut buf).unwrap().len()
+            })
+        });
+        group.bench_function("ser/Cobs<Slice>", |b| {
+            let mut buf = [0u8; BUF_SIZE];
+            b.iter(|| to_slice_cobs(black_box(&value), &mut buf).unwrap().len())
+        });
+
+        group.bench_function("de/from_bytes", |b| {
+            b.iter(|| {
+                let out: $ty = from_bytes(black_box(&plain)).unwrap();
+                black_box(&out);
+            })
+        });
+        group.bench_function("de/from_bytes_trusted", |b| {
+            b.iter(|| {
+                // `plain` was serialized from a value of the same type just above
+                let out: $ty = unsafe { from_bytes_trusted(black_box(&plain)) }.unwrap();
+                black_box(&out);
+            })
+        });
+        group.bench_function("de/take_from_bytes", |b| {
+            b.iter(|| {
+                let (out, rest): ($ty, _) = take_from_bytes(black_box(&plain)).unwrap();
+                black_box((&out, rest));
+            })
+        });
+        group.bench_function("de/from_bytes_cobs", |b| {
+            // Decoding is destructive, so every iteration gets a fresh copy of the frame
+            b.iter_batched(
+                || cobs.clone(),
+                |mut buf| {
+                    let out: $ty = from_bytes_cobs(&mut buf).unwrap();
+                    black_box(&out);
+                },
+                BatchSize::SmallInput,
+            )
+        });
+
+        group.finish();
+    }};
+}
+
+fn shapes(c: &mut Criterion) {
+    let bytes: Vec<u8> = (0..4096u32).map(|i| (i % 251) as u8).collect();
+    let tags = vec!["gateway", "uart0", "retry", "crc-ok"];
+
+    bench_shape!(c, "telemetry", Telemetry, telemetry(7));
+    bench_shape!(c, "imu", Imu, imu(7));
+    bench_shape!(c, "imu_fixed", FixedImu, FixedImu(imu(7)));
+    bench_shape!(
+        c,
+        "payload_4k",
+        Payload<'_>,
+        Payload {
+            id: 42,
+            bytes: &bytes
+        }
+    );
+    bench_shape!(c, "deep_enum", Expr, expr(48));
+    bench_shape!(c, "map_256", Lookup, lookup());
+    bench_shape!(
+        c,
+        "strings",
+        LogRecord<'_>,
+        LogRecord {
+            level: 3,
+            target: "bridge::uart::rx",
+            message: "frame dropped: receive buffer overrun while waiting for sentinel",
+            tags: tags.clone(),
+        }
+    );
+}
+
+fn batch(c: &mut Criterion) {
+    let msgs: Vec<Telemetry> = (0..BATCH_LEN as u32).map(telemetry).collect();
+
+    let mut stream = vec![0u8; BATCH_LEN * 64];
+    let mut used = 0;
+    for msg in msgs.iter() {
+        used += to_slice(msg, &mut stream[used..]).unwrap().len();
+    }
+    stream.truncate(used);
+
+    let mut group = c.benchmark_group("batch");
+    group.throughput(Throughput::Elements(BATCH_LEN as u64));
+
+    group.bench_function("ser/Slice", |b| {
+        let mut buf = vec![0u8; BATCH_LEN * 64];
+        b.iter(|| {
+            let mut used = 0;
+            for msg in msgs.iter() {
+                used += to_slice(black_box(msg), &mut buf[used..]).unwrap().len();
+            }
+            used
+        })
+    });
+    group.bench_function("de/take_from_bytes", |b| {
+        b.iter(|| {
+            let mut rest: &[u8] = black_box(&stream);
+            while !rest.is_empty() {
+                let (out, next): (Telemetry, _) = take_from_bytes(rest).unwrap();
+                black_box(&out);
+                rest = next;
+            }
+        })
+    });
+    group.bench_function("de/iter_from_bytes", |b| {
+        b.iter(|| {
+            for msg in iter_from_bytes::<Telemetry>(black_box(&stream)) {
+                black_box(&msg.unwrap());
+            }
+        })
+    });
+
+    group.finish();
+}
+
+criterion_group!(benches, shapes, batch);
+criterion_main!(benches);
@@ -0,0 +1,341 @@
+//! Derive macros for [`postcard`](https://docs.rs/postcard/).
+//!
+//! These are re-exported by `postcard` when its `derive` feature is enabled, and should
+//! be used from there rather than depending on this crate directly.
+
+use proc_macro::TokenStream;
+use proc_macro2::{Span, TokenStream as TokenStream2};
+use quote::{format_ident, quote, quote_spanned};
+use syn::{
+    parse_macro_input, parse_quote, spanned::Spanned, Data, DeriveInput, Fields, GenericParam,
+    Generics, Index, Lifetime, Member,
+};
+
+/// Derive the `postcard::MaxSize` trait for a struct or enum.
+///
+/// Every field must itself implement `MaxSize`. For enums, the result is the size of the
+/// largest variant plus the largest possible varint discriminant.
+#[proc_macro_derive(MaxSize)]
+pub fn derive_max_size(item: TokenStream) -> TokenStream {
+    let input = parse_macro_input!(item as DeriveInput);
+
+    let span = input.span();
+    let name = input.ident;
+
+    // Add a bound `T: MaxSize` to every type parameter T.
+    let generics = add_trait_bounds(input.generics);
+    let (impl_generics, ty_generics, where_clause) = generics.split_for_impl();
+
+    let max_size = max_size_of(&input.data, span).unwrap_or_else(syn::Error::into_compile_error);
+
+    let expanded = quote! {
+        impl #impl_generics ::postcard::MaxSize for #name #ty_generics #where_clause {
+            const POSTCARD_MAX_SIZE: usize = #max_size;
+        }
+    };
+
+    expanded.into()
+}
+
+fn add_trait_bounds(mut generics: Generics) -> Generics {
+    for param in &mut generics.params {
+        if let GenericParam::Type(ref mut type_param) = *param {
+            type_param.bounds.push(parse_quote!(::postcard::MaxSize));
+        }
+    }
+    generics
+}
+
+fn max_size_of(data: &Data, span: Span) -> Result<TokenStream2, syn::Error> {
+    match data {
+        Data::Struct(data) => Ok(sum_of_fields(&data.fields)),
+        Data::Enum(data) => {
+            // Variants are identified by their index, not their discriminant value
+            let max_index = data.variants.len().saturating_sub(1);
+
+            let variant_sizes = data.variants.iter().map(|variant| {
+                let size = sum_of_fields(&variant.fields);
+                quote! {
+                    let variant_size = #size;
+                    if variant_size > largest {
+                        largest = variant_size;
+                    }
+                }
+            });
+
+            Ok(quote! {
+                {
+                    let mut largest = 0;
+                    #( #variant_sizes )*
+                    ::postcard::max_size::varint_max_size(#max_index) + largest
+                }
+            })
+        }
+        Data::Union(_) => Err(syn::Error::new(
+            span,
+            "unions are not supported by `postcard::MaxSize`",
+        )),
+    }
+}
+
+fn sum_of_fields(fields: &Fields) -> TokenStream2 {
+    let sizes = fields.iter().map(|field| {
+        let ty = &field.ty;
+        quote_spanned! { field.span() => <#ty as ::postcard::MaxSize>::POSTCARD_MAX_SIZE }
+    });
+
+    quote! {
+        0 #( + #sizes )*
+    }
+}
+
+/// Derive the `postcard::FixedLayout` trait for a struct.
+///
+/// Every field must itself implement `FixedLayout`, and be serialized by serde in
+/// declaration order. Enums, unions and generic structs are not supported. This is the
+/// only way to implement `FixedLayout` outside of `postcard`.
+#[proc_macro_derive(FixedLayout)]
+pub fn derive_fixed_layout(item: TokenStream) -> TokenStream {
+    let input = parse_macro_input!(item as DeriveInput);
+
+    fixed_layout_impl(&input)
+        .unwrap_or_else(syn::Error::into_compile_error)
+        .into()
+}
+
+fn fixed_layout_impl(input: &DeriveInput) -> Result<TokenStream2, syn::Error> {
+    let name = &input.ident;
+
+    // The serialized bytes are built in a `[u8; SIZE]`, which needs a concrete size
+    if !input.generics.params.is_empty() {
+        return Err(syn::Error::new(
+            input.generics.span(),
+            "generic structs are not supported by `postcard::FixedLayout`",
+        ));
+    }
+
+    let fields = match &input.data {
+        Data::Struct(data) => &data.fields,
+        _ => {
+            return Err(syn::Error::new(
+                input.span(),
+                "only structs are supported by `postcard::FixedLayout`",
+            ))
+        }
+    };
+
+    let size = quote! {
+        <#name as ::postcard::FixedLayout>::SIZE
+    };
+    let field_sizes = fields.iter().map(|field| {
+        let ty = &field.ty;
+        quote_spanned! { field.span() => <#ty as ::postcard::FixedLayout>::SIZE }
+    });
+
+    let members: Vec<Member> = fields
+        .iter()
+        .enumerate()
+        .map(|(i, field)| match &field.ident {
+            Some(ident) => Member::Named(ident.clone()),
+            None => Member::Unnamed(Index::from(i)),
+        })
+        .collect();
+    let vars: Vec<_> = (0..members.len())
+        .map(|i| format_ident!("__field{}", i))
+        .collect();
+    let tys: Vec<_> = fields.iter().map(|field| &field.ty).collect();
+
+    let construct = match fields {
+        Fields::Named(_) => quote! { #name { #( #members: #vars ),* } },
+        Fields::Unnamed(_) => quote! { #name( #( #vars ),* ) },
+        Fields::Unit => quote! { #name },
+    };
+
+    // Each field is placed at a constant offset in a slice of constant length, so
+    // the per-field bounds checks are optimized out.
+    Ok(quote! {
+        impl ::postcard::__private::FixedLayoutSealed for #name {}
+
+        impl ::postcard::FixedLayout for #name {
+            const SIZE: usize = 0 #( + #field_sizes )*;
+
+            #[inline]
+            fn write_le(&self, out: &mut [u8]) {
+                let out = &mut out[..#size];
+                let offset = 0;
+                #(
+                    let end = offset + <#tys as ::postcard::FixedLayout>::SIZE;
+                    ::postcard::FixedLayout::write_le(&self.#members, &mut out[offset..end]);
+                    let offset = end;
+                )*
+                let _ = (out, offset);
+            }
+
+            #[inline]
+            fn read_le(bytes: &[u8]) -> ::core::option::Option<Self> {
+                let bytes = &bytes[..#size];
+                let offset = 0;
+                #(
+                    let end = offset + <#tys as ::postcard::FixedLayout>::SIZE;
+                    let #vars = <#tys as ::postcard::FixedLayout>::read_le(&bytes[offset..end])?;
+                    let offset = end;
+                )*
+                let _ = (bytes, offset);
+                ::core::option::Option::Some(#construct)
+            }
+
+            #[doc(hidden)]
+            fn serialize_fixed<S: ::postcard::__private::Serializer>(
+                &self,
+                serializer: S,
+            ) -> ::core::result::Result<S::Ok, S::Error> {
+                let mut buf = [0u8; #size];
+                ::postcard::FixedLayout::write_le(self, &mut buf);
+                ::postcard::fixed::serialize_le_bytes(&buf, serializer)
+            }
+        }
+    })
+}
+
+/// Derive the `postcard::DeserializeIn` trait for a struct.
+///
+/// Every field must itself implement `DeserializeIn`, and the struct may have at most one
+/// lifetime parameter, which is used as the lifetime of the arena. Enums and unions are not
+/// supported.
+#[proc_macro_derive(DeserializeIn)]
+pub fn derive_deserialize_in(item: TokenStream) -> TokenStream {
+    let input = parse_macro_input!(item as DeriveInput);
+
+    deserialize_in_impl(&input)
+        .unwrap_or_else(syn::Error::into_compile_error)
+        .into()
+}
+
+fn deserialize_in_impl(input: &DeriveInput) -> Result<TokenStream2, syn::Error> {
+    let name = &input.ident;
+
+    let fields = match &input.data {
+        Data::Struct(data) => &data.fields,
+        _ => {
+            return Err(syn::Error::new(
+                input.span(),
+                "only structs are supported by `postcard::DeserializeIn`",
+            ))
+        }
+    };
+
+    // The arena lifetime is the struct's own lifetime parameter if it has one
+    let mut generics = input.generics.clone();
+    let arena: Lifetime = match generics.lifetimes().count() {
+        0 => {
+            let arena: Lifetime = parse_quote!('__arena);
+            generics.params.insert(0, parse_quote!(#arena));
+            arena
+        }
+        1 => generics.lifetimes().next().unwrap().lifetime.clone(),
+        _ => {
+            return Err(syn::Error::new(
+                input.generics.span(),
+                "only one lifetime is supported by `postcard::DeserializeIn`",
+            ))
+        }
+    };
+    for param in &mut generics.params {
+        if let GenericParam::Type(ref mut type_param) = *param {
+            type_param
+                .bounds
+                .push(parse_quote!(::postcard::DeserializeIn<#arena>));
+        }
+    }
+    let (impl_generics, _, where_clause) = generics.split_for_impl();
+    let (_, ty_generics, _) = input.generics.split_for_impl();
+
+    // The visitor holds a reference to the arena, with its own lifetime
+    let mut visitor_generics = generics.clone();
+    visitor_generics.params.insert(0, parse_quote!('__x));
+    let (visitor_impl_generics, visitor_ty_generics, _) = visitor_generics.split_for_impl();
+    let mut de_generics = visitor_generics.clone();
+    de_generics.params.push(parse_quote!('__de));
+    let (de_impl_generics, _, _) = de_generics.split_for_impl();
+
+    let vars: Vec<_> = (0..fields.len())
+        .map(|i| format_ident!("__field{}", i))
+        .collect();
+    let indices = 0..fields.len();
+    let tys = fields.iter().map(|field| &field.ty);
+    let len = fields.len();
+    let name_str = name.to_string();
+
+    let (construct, deserialize) = match fields {
+        Fields::Named(_) => {
+            let idents: Vec<_> = fields.iter().map(|f| f.ident.as_ref().unwrap()).collect();
+            let names = idents.iter().map(|ident| ident.to_string());
+            (
+                quote! { #name { #( #idents: #vars ),* } },
+                quote! { deserialize_struct(#name_str, &[ #( #names ),* ], visitor) },
+            )
+        }
+        Fields::Unnamed(_) => (
+            quote! { #name( #( #vars ),* ) },
+            quote! { deserialize_tuple_struct(#name_str, #len, visitor) },
+        ),
+        Fields::Unit => (
+            quote! { #name },
+            quote! { deserialize_tuple_struct(#name_str, 0, visitor) },
+        ),
+    };
+
+    Ok(quote! {
+        impl #impl_generics ::postcard::DeserializeIn<#arena> for #name #ty_generics #where_clause {
+            fn deserialize_in<'__de, __D>(
+                deserializer: __D,
+                arena: &::postcard::arena::Arena<#arena>,
+            ) -> ::core::result::Result<Self, __D::Error>
+            where
+                __D: ::postcard::__private::Deserializer<'__de>,
+            {
+                struct __Visitor #visitor_impl_generics #where_clause {
+                    arena: &'__x ::postcard::arena::Arena<#arena>,
+                    marker: ::postcard::__private::PhantomData<fn() -> #name #ty_generics>,
+                }
+
+                impl #de_impl_generics ::postcard::__private::Visitor<'__de>
+                    for __Visitor #visitor_ty_generics #where_clause
+                {
+                    type Value = #name #ty_generics;
+
+                    fn expecting(
+                        &self,
+                        formatter: &mut ::postcard::__private::Formatter,
+                    ) -> ::postcard::__private::FmtResult {
+                        formatter.write_str(concat!("struct ", #name_str))
+                    }
+
+                    fn visit_seq<__A>(
+                        self,
+                        mut seq: __A,
+                    ) -> ::core::result::Result<Self::Value, __A::Error>
+                    where
+                        __A: ::postcard::__private::SeqAccess<'__de>,
+                    {
+                        #(
+                            let #vars = ::postcard::__private::next_field::<#tys, __A>(
+                                &mut seq,
+                                self.arena,
+                                #indices,
+                                &self,
+                            )?;
+                        )*
+                        ::core::result::Result::Ok(#construct)
+                    }
+                }
+
+                let visitor = __Visitor {
+                    arena,
+                    marker: ::postcard::__private::PhantomData,
+                };
+                deserializer.#deserialize
+            }
+        }
+    })
+}
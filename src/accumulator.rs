@@ -0,0 +1,337 @@
+//! # Streaming COBS Frame Accumulation
+//!
+//! Data read from a UART, socket or pipe rarely arrives one complete COBS frame at a
+//! time. [`CobsAccumulator`] is fed chunks of arbitrary size, collects partial frames in
+//! an internal buffer of `N` bytes, and yields one deserialized message whenever a frame
+//! is completed by its `0x00` terminator.
+//!
+//! Frames that do not fit the buffer are dropped up to and including their terminator,
+//! and reported as [`FeedResult::OverFull`], so the accumulator stays in sync with the
+//! stream and the following frame is decoded normally.
+//!
+//! ## Example
+//!
+//! ```rust
+//! # #[cfg(feature = "heapless")] {
+//! use postcard::accumulator::{CobsAccumulator, FeedResult};
+//! use postcard::to_vec_cobs;
+//! use serde::{Deserialize, Serialize};
+//!
+//! #[derive(Serialize, Deserialize, Debug, PartialEq)]
+//! struct Reading {
+//!     channel: u8,
+//!     value: u32,
+//! }
+//!
+//! let mut stream = heapless::Vec::<u8, 64>::new();
+//! for channel in 0..3 {
+//!     let frame = to_vec_cobs::<_, 16>(&Reading { channel, value: 1000 }).unwrap();
+//!     stream.extend_from_slice(&frame).unwrap();
+//! }
+//!
+//! let mut acc = CobsAccumulator::<32>::new();
+//! let mut received = 0;
+//!
+//! // Bytes arrive in chunks of five, not aligned to frames
+//! for mut chunk in stream.chunks(5) {
+//!     while !chunk.is_empty() {
+//!         chunk = match acc.feed::<Reading>(chunk) {
+//!             FeedResult::Consumed => break,
+//!             FeedResult::OverFull(rest) | FeedResult::DeserError(rest) => rest,
+//!             FeedResult::Success { data, remaining } => {
+//!                 assert_eq!(data.channel, received);
+//!                 received += 1;
+//!                 remaining
+//!             }
+//!         };
+//!     }
+//! }
+//! assert_eq!(received, 3);
+//! # }
+//! ```
+
+use crate::de::from_bytes_cobs;
+use crate::scan::find_zero;
+use serde::de::{Deserialize, DeserializeOwned};
+
+/// An accumulator for COBS encoded frames, with an internal buffer of `N` bytes.
+///
+/// `N` must be large enough to hold the largest encoded frame, including its `0x00`
+/// terminator. See [`cobs_max_size`](crate::max_size::cobs_max_size).
+pub struct CobsAccumulator<const N: usize> {
+    buf: [u8; N],
+    idx: usize,
+    overflowed: bool,
+}
+
+/// The result of feeding a chunk of data to a [`CobsAccumulator`].
+///
+/// `R` is the type of the unprocessed remainder of the chunk, `&[u8]` when feeding with
+/// [`feed`](CobsAccumulator::feed) or [`feed_ref`](CobsAccumulator::feed_ref), and
+/// `&mut [u8]` when feeding with [`feed_mut`](CobsAccumulator::feed_mut).
+#[derive(Debug)]
+pub enum FeedResult<T, R> {
+    /// The whole chunk was consumed without completing a frame
+    Consumed,
+
+    /// A frame did not fit in the buffer, and was dropped up to and including its
+    /// terminator. Contains the remainder of the chunk after the dropped frame.
+    OverFull(R),
+
+    /// A frame was completed, but could not be decoded or deserialized. Contains the
+    /// remainder of the chunk after the frame.
+    DeserError(R),
+
+    /// A frame was completed and deserialized
+    Success {
+        /// The deserialized message
+        data: T,
+
+        /// The remainder of the chunk after the frame
+        remaining: R,
+    },
+}
+
+/// What the internal buffer did with a chunk, along with the number of bytes of the
+/// chunk that were used
+enum Step {
+    Consumed,
+    OverFull(usize),
+    Frame(usize),
+}
+
+impl<const N: usize> CobsAccumulator<N> {
+    /// Create a new, empty accumulator
+    pub const fn new() -> Self {
+        CobsAccumulator {
+            buf: [0; N],
+            idx: 0,
+            overflowed: false,
+        }
+    }
+
+    /// Feed a chunk of data, copying it into the internal buffer.
+    ///
+    /// At most one message is returned per call. If the result carries a remainder,
+    /// it should be fed again to process any further frames in the chunk.
+    pub fn feed<'a, T>(&mut self, input: &'a [u8]) -> FeedResult<T, &'a [u8]>
+    where
+        T: DeserializeOwned,
+    {
+        self.feed_ref(input)
+    }
+
+    /// Feed a chunk of data, copying it into the internal buffer.
+    ///
+    /// Like [`feed`](CobsAccumulator::feed), but the returned message may borrow
+    /// from the internal buffer, which stays borrowed until the message is dropped.
+    pub fn feed_ref<'de, 'a, T>(&'de mut self, input: &'a [u8]) -> FeedResult<T, &'a [u8]>
+    where
+        T: Deserialize<'de>,
+    {
+        match self.push(input) {
+            Step::Consumed => FeedResult::Consumed,
+            Step::OverFull(used) => FeedResult::OverFull(&input[used..]),
+            Step::Frame(used) => {
+                let len = self.idx;
+                self.idx = 0;
+                match from_bytes_cobs::<T>(&mut self.buf[..len]) {
+                    Ok(data) => FeedResult::Success {
+                        data,
+                        remaining: &input[used..],
+                    },
+                    Err(_) => FeedResult::DeserError(&input[used..]),
+                }
+            }
+        }
+    }
+
+    /// Feed a mutable chunk of data.
+    ///
+    /// When no partial frame is pending and the chunk contains a complete frame, the
+    /// frame is decoded in place inside the chunk, without copying it into the internal
+    /// buffer. Otherwise this behaves like [`feed_ref`](CobsAccumulator::feed_ref).
+    /// The returned message may borrow from either the chunk or the internal buffer.
+    pub fn feed_mut<'a, T>(&'a mut self, input: &'a mut [u8]) -> FeedResult<T, &'a mut [u8]>
+    where
+        T: Deserialize<'a>,
+    {
+        if self.idx == 0 && !self.overflowed {
+            if let Some(n) = find_zero(input) {
+                let (frame, remaining) = input.split_at_mut(n + 1);
+                return match from_bytes_cobs::<T>(frame) {
+                    Ok(data) => FeedResult::Success { data, remaining },
+                    Err(_) => FeedResult::DeserError(remaining),
+                };
+            }
+        }
+
+        match self.push(input) {
+            Step::Consumed => FeedResult::Consumed,
+            Step::OverFull(used) => FeedResult::OverFull(&mut input[used..]),
+            Step::Frame(used) => {
+                let len = self.idx;
+                self.idx = 0;
+                let remaining = &mut input[used..];
+                match from_bytes_cobs::<T>(&mut self.buf[..len]) {
+                    Ok(data) => FeedResult::Success { data, remaining },
+                    Err(_) => FeedResult::DeserError(remaining),
+                }
+            }
+        }
+    }
+
+    /// Copy input up to and including the next terminator into the buffer.
+    ///
+    /// Once a frame overflows, the rest of it is discarded until its terminator arrives,
+    /// so that the next frame starts with an empty buffer.
+    fn push(&mut self, input: &[u8]) -> Step {
+        let (chunk, complete) = match find_zero(input) {
+            Some(n) => (&input[..=n], true),
+            None => (input, false),
+        };
+
+        if !self.overflowed {
+            let end = self.idx + chunk.len();
+            if end <= N {
+                self.buf[self.idx..end].copy_from_slice(chunk);
+                self.idx = end;
+            } else {
+                self.overflowed = true;
+            }
+        }
+
+        if !complete {
+            Step::Consumed
+        } else if self.overflowed {
+            self.overflowed = false;
+            self.idx = 0;
+            Step::OverFull(chunk.len())
+        } else {
+            Step::Frame(chunk.len())
+        }
+    }
+}
+
+impl<const N: usize> Default for CobsAccumulator<N> {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+#[cfg(feature = "heapless")]
+#[cfg(test)]
+mod test {
+    use super::*;
+    use crate::to_vec_cobs;
+    use heapless::Vec;
+    use serde::{Deserialize, Serialize};
+
+    #[derive(Serialize, Deserialize, Debug, PartialEq, Clone, Copy)]
+    struct Demo {
+        a: u32,
+        b: [u8; 6],
+    }
+
+    const DEMO: Demo = Demo {
+        a: 0x0100_0000,
+        b: [0, 1, 2, 0, 0xFF, 0],
+    };
+
+    #[test]
+    fn chunked() {
+        let frame = to_vec_cobs::<_, 32>(&DEMO).unwrap();
+        let mut stream: Vec<u8, 128> = Vec::new();
+        for _ in 0..4 {
+            stream.extend_from_slice(&frame).unwrap();
+        }
+
+        for chunk_len in 1..stream.len() {
+            let mut acc = CobsAccumulator::<32>::new();
+            let mut received = 0;
+            for mut chunk in stream.chunks(chunk_len) {
+                loop {
+                    chunk = match acc.feed::<Demo>(chunk) {
+                        FeedResult::Consumed => break,
+                        FeedResult::Success { data, remaining } => {
+                            assert_eq!(data, DEMO);
+                            received += 1;
+                            remaining
+                        }
+                        _ => panic!("unexpected result"),
+                    };
+                }
+            }
+            assert_eq!(received, 4);
+        }
+    }
+
+    #[test]
+    fn overflow_keeps_sync() {
+        let big = to_vec_cobs::<_, 64>(&[0x55u8; 40][..]).unwrap();
+        let small = to_vec_cobs::<_, 32>(&DEMO).unwrap();
+        let mut acc = CobsAccumulator::<16>::new();
+
+        // The oversized frame arrives over several chunks
+        let (head, tail) = big.split_at(20);
+        assert!(matches!(acc.feed::<Demo>(head), FeedResult::Consumed));
+        let mut input: Vec<u8, 64> = Vec::new();
+        input.extend_from_slice(tail).unwrap();
+        input.extend_from_slice(&small).unwrap();
+
+        let rest = match acc.feed::<Demo>(&input) {
+            FeedResult::OverFull(rest) => rest,
+            _ => panic!("expected overflow"),
+        };
+        assert_eq!(rest, small.as_ref());
+        match acc.feed::<Demo>(rest) {
+            FeedResult::Success { data, remaining } => {
+                assert_eq!(data, DEMO);
+                assert!(remaining.is_empty());
+            }
+            _ => panic!("expected success"),
+        }
+    }
+
+    #[test]
+    fn bad_frame() {
+        let mut acc = CobsAccumulator::<16>::new();
+        match acc.feed::<Demo>(&[0x02, 0x01, 0x00, 0x01]) {
+            FeedResult::DeserError(rest) => assert_eq!(rest, &[0x01]),
+            _ => panic!("expected error"),
+        }
+    }
+
+    #[test]
+    fn in_place() {
+        let frame = to_vec_cobs::<_, 32>(&DEMO).unwrap();
+        let mut stream: Vec<u8, 64> = Vec::new();
+        stream.extend_from_slice(&frame[3..]).unwrap();
+        stream.extend_from_slice(&frame).unwrap();
+
+        let mut acc = CobsAccumulator::<32>::new();
+        // Start of the frame, accumulated by copying
+        assert!(matches!(
+            acc.feed::<Demo>(&frame[..3]),
+            FeedResult::Consumed
+        ));
+
+        let rest = match acc.feed_mut::<Demo>(&mut stream) {
+            FeedResult::Success { data, remaining } => {
+                assert_eq!(data, DEMO);
+                remaining
+            }
+            _ => panic!("expected success"),
+        };
+
+        // The second frame lies entirely within the chunk, and is decoded in place
+        let mut acc = CobsAccumulator::<0>::new();
+        match acc.feed_mut::<Demo>(rest) {
+            FeedResult::Success { data, remaining } => {
+                assert_eq!(data, DEMO);
+                assert!(remaining.is_empty());
+            }
+            _ => panic!("expected success"),
+        }
+    }
+}
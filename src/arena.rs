@@ -0,0 +1,694 @@
+//! # Arena Deserialization
+//!
+//! Deserializing owned `String`s and `Vec`s costs one allocation per field, and freeing a
+//! message means freeing every one of them again. An [`Arena`] is a bump allocator over a
+//! caller provided buffer: with [`from_bytes_in`](crate::from_bytes_in), the strings, byte
+//! buffers and vectors of a message are placed in the arena instead, and the whole message
+//! is freed at once when the arena's buffer is released.
+//!
+//! Messages use the arena-backed [`ArenaStr`], [`ArenaBytes`] and [`ArenaVec`] in place of
+//! `String`, `Vec<u8>` and `Vec<T>`, and implement [`DeserializeIn`] rather than serde's
+//! `Deserialize`. `DeserializeIn` can be derived for structs with the `derive` feature.
+//! Nothing borrows from the input, so the input buffer can be reused right away.
+//!
+//! The arena types are encoded exactly like the types they replace, so the sender is free
+//! to serialize `String`s and `Vec`s.
+//!
+//! ## Example
+//!
+//! ```rust
+//! # #[cfg(all(feature = "heapless", feature = "derive"))] {
+//! use postcard::arena::{Arena, ArenaBytes, ArenaStr, ArenaVec};
+//! use postcard::{from_bytes_in, to_vec, DeserializeIn};
+//! use serde::Serialize;
+//!
+//! #[derive(Serialize)]
+//! struct Header<'a> {
+//!     name: &'a str,
+//!     value: &'a str,
+//! }
+//!
+//! #[derive(Serialize)]
+//! struct Request<'a> {
+//!     path: &'a str,
+//!     headers: &'a [Header<'a>],
+//!     body: &'a [u8],
+//! }
+//!
+//! #[derive(DeserializeIn, Debug)]
+//! struct ArenaHeader<'a> {
+//!     name: ArenaStr<'a>,
+//!     value: ArenaStr<'a>,
+//! }
+//!
+//! #[derive(DeserializeIn, Debug)]
+//! struct ArenaRequest<'a> {
+//!     path: ArenaStr<'a>,
+//!     headers: ArenaVec<'a, ArenaHeader<'a>>,
+//!     body: ArenaBytes<'a>,
+//! }
+//!
+//! let mut storage = [0u8; 256];
+//! let arena = Arena::new(&mut storage);
+//!
+//! let mut requests = Vec::new();
+//! for path in &["/a", "/b/c"] {
+//!     // A receive buffer that only lives for one iteration
+//!     let rx_buf: heapless::Vec<u8, 64> = to_vec(&Request {
+//!         path,
+//!         headers: &[Header { name: "host", value: "local" }],
+//!         body: &[1, 2, 3],
+//!     })
+//!     .unwrap();
+//!     let req: ArenaRequest = from_bytes_in(&rx_buf, &arena).unwrap();
+//!     requests.push(req);
+//! }
+//!
+//! assert_eq!(requests[0].path, "/a");
+//! assert_eq!(requests[1].path, "/b/c");
+//! assert_eq!(requests[1].headers[0].value, "local");
+//! assert_eq!(requests[1].body, [1, 2, 3]);
+//! # }
+//! ```
+//!
+//! ## Implementing `DeserializeIn`
+//!
+//! `DeserializeIn` is implemented for the arena types, integers, floats, `bool`, `char`,
+//! `()` and `Option`s of `DeserializeIn` types. Types that hold no arena data can forward
+//! to their `Deserialize` implementation:
+//!
+//! ```rust
+//! use postcard::arena::{Arena, DeserializeIn};
+//! use serde::{Deserialize, Deserializer};
+//!
+//! #[derive(Deserialize)]
+//! enum Method {
+//!     Get,
+//!     Post,
+//! }
+//!
+//! impl<'a> DeserializeIn<'a> for Method {
+//!     fn deserialize_in<'de, D>(deserializer: D, _arena: &Arena<'a>) -> Result<Self, D::Error>
+//!     where
+//!         D: Deserializer<'de>,
+//!     {
+//!         Method::deserialize(deserializer)
+//!     }
+//! }
+//! ```
+
+use core::cell::Cell;
+use core::fmt;
+use core::marker::PhantomData;
+use core::mem::{align_of, size_of, MaybeUninit};
+use core::ops::{Deref, DerefMut};
+use core::ptr;
+use core::slice;
+
+use serde::de::{self, DeserializeSeed, Deserializer, Expected, SeqAccess, Visitor};
+use serde::ser::{Serialize, Serializer};
+
+/// A bump allocator over a borrowed byte buffer.
+///
+/// Allocations are never freed individually. Once all values deserialized into the arena
+/// have been dropped, the arena can be dropped and its buffer reused for a new arena.
+pub struct Arena<'a> {
+    free: Cell<&'a mut [u8]>,
+    used: Cell<usize>,
+    exhausted: Cell<bool>,
+}
+
+impl<'a> Arena<'a> {
+    /// Create a new arena, allocating from the given buffer
+    pub fn new(buf: &'a mut [u8]) -> Self {
+        Arena {
+            free: Cell::new(buf),
+            used: Cell::new(0),
+            exhausted: Cell::new(false),
+        }
+    }
+
+    /// Copy `data` into the arena, returning the copy, or `None` if the arena does not have
+    /// enough space left
+    pub fn alloc_copy(&self, data: &[u8]) -> Option<&'a mut [u8]> {
+        let out = self.alloc_bytes(0, data.len())?;
+        out.copy_from_slice(data);
+        Some(out)
+    }
+
+    /// Copy `s` into the arena, returning the copy, or `None` if the arena does not have
+    /// enough space left
+    pub fn alloc_str(&self, s: &str) -> Option<&'a str> {
+        let out = self.alloc_copy(s.as_bytes())?;
+        // SAFETY: `out` is a copy of a valid `str`
+        Some(unsafe { core::str::from_utf8_unchecked(out) })
+    }
+
+    /// The number of bytes allocated so far, including padding for alignment
+    pub fn used(&self) -> usize {
+        self.used.get()
+    }
+
+    /// The number of bytes still available
+    pub fn remaining(&self) -> usize {
+        let free = self.free.take();
+        let len = free.len();
+        self.free.set(free);
+        len
+    }
+
+    /// Allocate `len` bytes, after skipping `pad` bytes
+    fn alloc_bytes(&self, pad: usize, len: usize) -> Option<&'a mut [u8]> {
+        let free = self.free.take();
+        let total = match pad.checked_add(len) {
+            Some(total) if total <= free.len() => total,
+            _ => {
+                self.free.set(free);
+                self.exhausted.set(true);
+                return None;
+            }
+        };
+
+        let (out, rest) = free.split_at_mut(total);
+        self.free.set(rest);
+        self.used.set(self.used.get() + total);
+        Some(&mut out[pad..])
+    }
+
+    /// Allocate space for `len` values of type `T`
+    fn alloc_uninit<T>(&self, len: usize) -> Option<&'a mut [MaybeUninit<T>]> {
+        let pad = {
+            let free = self.free.take();
+            let pad = free.as_ptr().align_offset(align_of::<T>());
+            self.free.set(free);
+            pad
+        };
+        let bytes = match size_of::<T>().checked_mul(len) {
+            Some(bytes) => bytes,
+            None => {
+                self.exhausted.set(true);
+                return None;
+            }
+        };
+
+        let out = self.alloc_bytes(pad, bytes)?;
+        // SAFETY: `out` is aligned for `T`, holds `len` values of `T`, and is borrowed
+        // mutably for `'a`. `MaybeUninit<T>` has no validity requirements.
+        Some(unsafe { slice::from_raw_parts_mut(out.as_mut_ptr() as *mut MaybeUninit<T>, len) })
+    }
+
+    /// Start tracking whether an allocation failed, see [`Arena::exhausted`]
+    pub(crate) fn reset_exhausted(&self) {
+        self.exhausted.set(false);
+    }
+
+    /// Whether an allocation failed since the last call to `reset_exhausted`
+    pub(crate) fn exhausted(&self) -> bool {
+        self.exhausted.get()
+    }
+}
+
+impl<'a> fmt::Debug for Arena<'a> {
+    fn fmt(&self, f: &mut fmt::Formatter) -> fmt::Result {
+        f.debug_struct("Arena")
+            .field("used", &self.used())
+            .field("remaining", &self.remaining())
+            .finish()
+    }
+}
+
+fn arena_full<E: de::Error>() -> E {
+    E::custom("the arena does not have enough space left")
+}
+
+/// A type that can be deserialized with its strings, byte buffers and vectors placed in
+/// an [`Arena`].
+///
+/// This is the arena counterpart of serde's `Deserialize`. See the
+/// [module level documentation](self) for more information.
+pub trait DeserializeIn<'a>: Sized {
+    /// Deserialize a value, allocating from `arena`
+    fn deserialize_in<'de, D>(deserializer: D, arena: &Arena<'a>) -> Result<Self, D::Error>
+    where
+        D: Deserializer<'de>;
+}
+
+/// A `DeserializeSeed` that deserializes a `T` into an arena, for use in visitors of
+/// types implementing [`DeserializeIn`].
+pub struct InArena<'x, 'a, T> {
+    arena: &'x Arena<'a>,
+    _t: PhantomData<fn() -> T>,
+}
+
+impl<'x, 'a, T> InArena<'x, 'a, T> {
+    /// Create a seed deserializing a `T` into `arena`
+    pub fn new(arena: &'x Arena<'a>) -> Self {
+        InArena {
+            arena,
+            _t: PhantomData,
+        }
+    }
+}
+
+impl<'x, 'a, 'de, T: DeserializeIn<'a>> DeserializeSeed<'de> for InArena<'x, 'a, T> {
+    type Value = T;
+
+    fn deserialize<D: Deserializer<'de>>(self, deserializer: D) -> Result<T, D::Error> {
+        T::deserialize_in(deserializer, self.arena)
+    }
+}
+
+macro_rules! impl_deserialize_in {
+    ($($ty:ty),* $(,)?) => {
+        $(
+            impl<'a> DeserializeIn<'a> for $ty {
+                #[inline]
+                fn deserialize_in<'de, D>(
+                    deserializer: D,
+                    _arena: &Arena<'a>,
+                ) -> Result<Self, D::Error>
+                where
+                    D: Deserializer<'de>,
+                {
+                    <$ty as serde::Deserialize>::deserialize(deserializer)
+                }
+            }
+        )*
+    };
+}
+
+impl_deserialize_in! {
+    bool, char, (),
+    u8, u16, u32, u64, u128, usize,
+    i8, i16, i32, i64, i128, isize,
+    f32, f64,
+}
+
+impl<'a, T: DeserializeIn<'a>> DeserializeIn<'a> for Option<T> {
+    fn deserialize_in<'de, D>(deserializer: D, arena: &Arena<'a>) -> Result<Self, D::Error>
+    where
+        D: Deserializer<'de>,
+    {
+        struct OptionVisitor<'x, 'a, T>(InArena<'x, 'a, T>);
+
+        impl<'x, 'a, 'de, T: DeserializeIn<'a>> Visitor<'de> for OptionVisitor<'x, 'a, T> {
+            type Value = Option<T>;
+
+            fn expecting(&self, formatter: &mut fmt::Formatter) -> fmt::Result {
+                formatter.write_str("an option")
+            }
+
+            fn visit_none<E: de::Error>(self) -> Result<Option<T>, E> {
+                Ok(None)
+            }
+
+            fn visit_unit<E: de::Error>(self) -> Result<Option<T>, E> {
+                Ok(None)
+            }
+
+            fn visit_some<D>(self, deserializer: D) -> Result<Option<T>, D::Error>
+            where
+                D: Deserializer<'de>,
+            {
+                self.0.deserialize(deserializer).map(Some)
+            }
+        }
+
+        deserializer.deserialize_option(OptionVisitor(InArena::new(arena)))
+    }
+}
+
+/// A string placed in an [`Arena`], deserialized like a `String`
+#[derive(Clone, Copy, PartialEq, Eq, PartialOrd, Ord, Hash)]
+pub struct ArenaStr<'a>(&'a str);
+
+impl<'a> ArenaStr<'a> {
+    /// The string, borrowed for the lifetime of the arena
+    pub fn as_str(&self) -> &'a str {
+        self.0
+    }
+}
+
+impl<'a> Deref for ArenaStr<'a> {
+    type Target = str;
+
+    fn deref(&self) -> &str {
+        self.0
+    }
+}
+
+impl<'a> fmt::Debug for ArenaStr<'a> {
+    fn fmt(&self, f: &mut fmt::Formatter) -> fmt::Result {
+        fmt::Debug::fmt(self.0, f)
+    }
+}
+
+impl<'a> fmt::Display for ArenaStr<'a> {
+    fn fmt(&self, f: &mut fmt::Formatter) -> fmt::Result {
+        fmt::Display::fmt(self.0, f)
+    }
+}
+
+impl<'a, 'b> PartialEq<&'b str> for ArenaStr<'a> {
+    fn eq(&self, other: &&'b str) -> bool {
+        self.0 == *other
+    }
+}
+
+impl<'a> Serialize for ArenaStr<'a> {
+    fn serialize<S: Serializer>(&self, serializer: S) -> Result<S::Ok, S::Error> {
+        serializer.serialize_str(self.0)
+    }
+}
+
+impl<'a> DeserializeIn<'a> for ArenaStr<'a> {
+    fn deserialize_in<'de, D>(deserializer: D, arena: &Arena<'a>) -> Result<Self, D::Error>
+    where
+        D: Deserializer<'de>,
+    {
+        struct StrVisitor<'x, 'a>(&'x Arena<'a>);
+
+        impl<'x, 'a, 'de> Visitor<'de> for StrVisitor<'x, 'a> {
+            type Value = ArenaStr<'a>;
+
+            fn expecting(&self, formatter: &mut fmt::Formatter) -> fmt::Result {
+                formatter.write_str("a string")
+            }
+
+            fn visit_str<E: de::Error>(self, v: &str) -> Result<ArenaStr<'a>, E> {
+                self.0.alloc_str(v).map(ArenaStr).ok_or_else(arena_full)
+            }
+        }
+
+        deserializer.deserialize_str(StrVisitor(arena))
+    }
+}
+
+/// A byte buffer placed in an [`Arena`], deserialized like a `Vec<u8>`
+#[derive(Clone, Copy, PartialEq, Eq, PartialOrd, Ord, Hash)]
+pub struct ArenaBytes<'a>(&'a [u8]);
+
+impl<'a> ArenaBytes<'a> {
+    /// The bytes, borrowed for the lifetime of the arena
+    pub fn as_bytes(&self) -> &'a [u8] {
+        self.0
+    }
+}
+
+impl<'a> Deref for ArenaBytes<'a> {
+    type Target = [u8];
+
+    fn deref(&self) -> &[u8] {
+        self.0
+    }
+}
+
+impl<'a> fmt::Debug for ArenaBytes<'a> {
+    fn fmt(&self, f: &mut fmt::Formatter) -> fmt::Result {
+        fmt::Debug::fmt(self.0, f)
+    }
+}
+
+impl<'a, 'b> PartialEq<&'b [u8]> for ArenaBytes<'a> {
+    fn eq(&self, other: &&'b [u8]) -> bool {
+        self.0 == *other
+    }
+}
+
+impl<'a, const N: usize> PartialEq<[u8; N]> for ArenaBytes<'a> {
+    fn eq(&self, other: &[u8; N]) -> bool {
+        self.0 == other
+    }
+}
+
+impl<'a> Serialize for ArenaBytes<'a> {
+    fn serialize<S: Serializer>(&self, serializer: S) -> Result<S::Ok, S::Error> {
+        serializer.serialize_bytes(self.0)
+    }
+}
+
+impl<'a> DeserializeIn<'a> for ArenaBytes<'a> {
+    fn deserialize_in<'de, D>(deserializer: D, arena: &Arena<'a>) -> Result<Self, D::Error>
+    where
+        D: Deserializer<'de>,
+    {
+        struct BytesVisitor<'x, 'a>(&'x Arena<'a>);
+
+        impl<'x, 'a, 'de> Visitor<'de> for BytesVisitor<'x, 'a> {
+            type Value = ArenaBytes<'a>;
+
+            fn expecting(&self, formatter: &mut fmt::Formatter) -> fmt::Result {
+                formatter.write_str("a byte buffer")
+            }
+
+            fn visit_bytes<E: de::Error>(self, v: &[u8]) -> Result<ArenaBytes<'a>, E> {
+                match self.0.alloc_copy(v) {
+                    Some(out) => Ok(ArenaBytes(out)),
+                    None => Err(arena_full()),
+                }
+            }
+
+            // Self-describing formats may encode bytes as a sequence
+            fn visit_seq<A: SeqAccess<'de>>(self, seq: A) -> Result<ArenaBytes<'a>, A::Error> {
+                fill_seq::<u8, A>(self.0, seq).map(|out| ArenaBytes(out))
+            }
+        }
+
+        deserializer.deserialize_bytes(BytesVisitor(arena))
+    }
+}
+
+/// A vector placed in an [`Arena`], deserialized like a `Vec<T>`.
+///
+/// The elements are dropped with the `ArenaVec`, but their memory is only released
+/// with the arena.
+pub struct ArenaVec<'a, T> {
+    items: &'a mut [T],
+}
+
+impl<'a, T> ArenaVec<'a, T> {
+    /// The elements, as a slice
+    pub fn as_slice(&self) -> &[T] {
+        self.items
+    }
+
+    /// The elements, as a mutable slice
+    pub fn as_mut_slice(&mut self) -> &mut [T] {
+        self.items
+    }
+}
+
+impl<'a, T> Deref for ArenaVec<'a, T> {
+    type Target = [T];
+
+    fn deref(&self) -> &[T] {
+        self.items
+    }
+}
+
+impl<'a, T> DerefMut for ArenaVec<'a, T> {
+    fn deref_mut(&mut self) -> &mut [T] {
+        self.items
+    }
+}
+
+impl<'a, T> Drop for ArenaVec<'a, T> {
+    fn drop(&mut self) {
+        // SAFETY: the elements are initialized, owned by this vector and not used again
+        unsafe { ptr::drop_in_place(self.items as *mut [T]) }
+    }
+}
+
+impl<'a, T: fmt::Debug> fmt::Debug for ArenaVec<'a, T> {
+    fn fmt(&self, f: &mut fmt::Formatter) -> fmt::Result {
+        fmt::Debug::fmt(&*self.items, f)
+    }
+}
+
+impl<'a, 'b, T: PartialEq<U>, U> PartialEq<ArenaVec<'b, U>> for ArenaVec<'a, T> {
+    fn eq(&self, other: &ArenaVec<'b, U>) -> bool {
+        self.items[..] == other.items[..]
+    }
+}
+
+impl<'a, T: Eq> Eq for ArenaVec<'a, T> {}
+
+impl<'a, T: PartialEq<U>, U> PartialEq<[U]> for ArenaVec<'a, T> {
+    fn eq(&self, other: &[U]) -> bool {
+        self.items[..] == other[..]
+    }
+}
+
+impl<'a, 'b, T: PartialEq<U>, U> PartialEq<&'b [U]> for ArenaVec<'a, T> {
+    fn eq(&self, other: &&'b [U]) -> bool {
+        self.items[..] == other[..]
+    }
+}
+
+impl<'a, T: PartialEq<U>, U, const N: usize> PartialEq<[U; N]> for ArenaVec<'a, T> {
+    fn eq(&self, other: &[U; N]) -> bool {
+        self.items[..] == other[..]
+    }
+}
+
+impl<'a, T: Serialize> Serialize for ArenaVec<'a, T> {
+    fn serialize<S: Serializer>(&self, serializer: S) -> Result<S::Ok, S::Error> {
+        serializer.collect_seq(self.items.iter())
+    }
+}
+
+impl<'a, T: DeserializeIn<'a>> DeserializeIn<'a> for ArenaVec<'a, T> {
+    fn deserialize_in<'de, D>(deserializer: D, arena: &Arena<'a>) -> Result<Self, D::Error>
+    where
+        D: Deserializer<'de>,
+    {
+        struct VecVisitor<'x, 'a, T>(&'x Arena<'a>, PhantomData<fn() -> T>);
+
+        impl<'x, 'a, 'de, T: DeserializeIn<'a> + 'a> Visitor<'de> for VecVisitor<'x, 'a, T> {
+            type Value = ArenaVec<'a, T>;
+
+            fn expecting(&self, formatter: &mut fmt::Formatter) -> fmt::Result {
+                formatter.write_str("a sequence")
+            }
+
+            fn visit_seq<A: SeqAccess<'de>>(self, seq: A) -> Result<ArenaVec<'a, T>, A::Error> {
+                fill_seq::<T, A>(self.0, seq).map(|items| ArenaVec { items })
+            }
+        }
+
+        deserializer.deserialize_seq(VecVisitor(arena, PhantomData))
+    }
+}
+
+/// Deserialize the elements of `seq` into a slice allocated from `arena`.
+///
+/// postcard reports the exact length of sequences, so the slice is allocated once, before
+/// its elements place their own data in the arena. Without a size hint, the slice is
+/// moved to a new allocation twice its size whenever it is full.
+fn fill_seq<'de, 'a, T, A>(arena: &Arena<'a>, mut seq: A) -> Result<&'a mut [T], A::Error>
+where
+    T: DeserializeIn<'a>,
+    A: SeqAccess<'de>,
+{
+    let hint = seq.size_hint().unwrap_or(0);
+    let mut buf = arena.alloc_uninit::<T>(hint).ok_or_else(arena_full)?;
+    let mut len = 0;
+
+    // Elements deserialized before an error are leaked, which is safe
+    while let Some(elem) = seq.next_element_seed(InArena::new(arena))? {
+        if len == buf.len() {
+            let grown = arena
+                .alloc_uninit::<T>((len * 2).max(4))
+                .ok_or_else(arena_full)?;
+            // SAFETY: arena allocations never overlap, and the elements are moved, as
+            // `buf` is not read again
+            unsafe { ptr::copy_nonoverlapping(buf.as_ptr(), grown.as_mut_ptr(), len) };
+            buf = grown;
+        }
+        buf[len] = MaybeUninit::new(elem);
+        len += 1;
+    }
+
+    // SAFETY: the first `len` elements have been initialized
+    Ok(unsafe { slice::from_raw_parts_mut(buf.as_mut_ptr() as *mut T, len) })
+}
+
+/// Deserialize field `index` of a struct deriving `DeserializeIn`, used by the derive macro
+#[doc(hidden)]
+pub fn next_field<'de, 'a, T, A>(
+    seq: &mut A,
+    arena: &Arena<'a>,
+    index: usize,
+    expected: &dyn Expected,
+) -> Result<T, A::Error>
+where
+    T: DeserializeIn<'a>,
+    A: SeqAccess<'de>,
+{
+    match seq.next_element_seed(InArena::new(arena))? {
+        Some(field) => Ok(field),
+        None => Err(de::Error::invalid_length(index, expected)),
+    }
+}
+
+#[cfg(test)]
+mod test {
+    use super::*;
+
+    #[test]
+    fn bump() {
+        let mut storage = [0u8; 8];
+        let arena = Arena::new(&mut storage);
+
+        let a = arena.alloc_copy(&[1, 2, 3]).unwrap();
+        let b = arena.alloc_copy(&[4, 5, 6, 7]).unwrap();
+        assert!(arena.alloc_copy(&[8, 9]).is_none());
+        let c = arena.alloc_copy(&[8]).unwrap();
+        assert_eq!((arena.used(), arena.remaining()), (8, 0));
+
+        assert_eq!(
+            (&a[..], &b[..], &c[..]),
+            (&[1, 2, 3][..], &[4, 5, 6, 7][..], &[8][..])
+        );
+        drop(arena);
+        assert_eq!(storage, [1, 2, 3, 4, 5, 6, 7, 8]);
+    }
+
+    #[test]
+    fn aligned() {
+        let mut storage = [0u8; 64];
+        let arena = Arena::new(&mut storage);
+
+        arena.alloc_copy(&[1]).unwrap();
+        let words = arena.alloc_uninit::<u64>(3).unwrap();
+        assert_eq!(words.len(), 3);
+        assert_eq!(words.as_ptr() as usize % align_of::<u64>(), 0);
+        assert!(arena.used() >= 1 + 24);
+        assert!(arena.alloc_uninit::<u64>(usize::MAX).is_none());
+        assert!(arena.exhausted());
+    }
+
+    #[test]
+    fn unknown_length() {
+        use serde::de::value::{Error, SeqDeserializer};
+
+        let mut storage = [0u8; 256];
+        let arena = Arena::new(&mut storage);
+
+        // `filter` hides the length of the sequence, so the vector has to grow
+        let seq = SeqDeserializer::<_, Error>::new((0..10u32).filter(|_| true));
+        let out = ArenaVec::<u32>::deserialize_in(seq, &arena).unwrap();
+        assert_eq!(out, [0, 1, 2, 3, 4, 5, 6, 7, 8, 9]);
+    }
+
+    #[test]
+    fn drops_elements() {
+        use core::sync::atomic::{AtomicUsize, Ordering};
+
+        static DROPPED: AtomicUsize = AtomicUsize::new(0);
+
+        struct Counted(u8);
+
+        impl Drop for Counted {
+            fn drop(&mut self) {
+                DROPPED.fetch_add(self.0 as usize, Ordering::SeqCst);
+            }
+        }
+
+        impl<'a> DeserializeIn<'a> for Counted {
+            fn deserialize_in<'de, D>(deserializer: D, _arena: &Arena<'a>) -> Result<Self, D::Error>
+            where
+                D: Deserializer<'de>,
+            {
+                <u8 as serde::Deserialize>::deserialize(deserializer).map(Counted)
+            }
+        }
+
+        let mut storage = [0u8; 16];
+        let arena = Arena::new(&mut storage);
+        let out: ArenaVec<Counted> = crate::from_bytes_in(&[0x03, 1, 2, 4], &arena).unwrap();
+        assert_eq!(DROPPED.load(Ordering::SeqCst), 0);
+        drop(out);
+        assert_eq!(DROPPED.load(Ordering::SeqCst), 7);
+    }
+}
@@ -0,0 +1,512 @@
+//! # Bulk Sequences of Primitives
+//!
+//! By default, serde serializes a `Vec<f32>` or `[u16; N]` one element at a time. The helpers
+//! in this module instead copy the whole element array to or from the serialized data at once,
+//! which is a single `memcpy` on little-endian targets.
+//!
+//! This includes byte buffers: serde has no way to tell a `Vec<u8>` or `[u8; N]` apart from any
+//! other sequence, so without these helpers every byte is pushed to the flavor, and read back
+//! from the input, on its own.
+//!
+//! The wire format is unchanged: a field using [`postcard::bulk`](self) is encoded exactly like
+//! the same `Vec<T>` without it, and a field using [`postcard::bulk::array`](mod@array) exactly
+//! like the plain `[T; N]`. Either side of a link can adopt the helpers independently.
+//!
+//! Supported element types are `u8`, `i8`, `u16`, `i16`, `u32`, `i32`, `f32`, `u64`, `i64`,
+//! `f64`, `u128` and `i128`. Sequences can be deserialized into `alloc::vec::Vec` (with the
+//! `alloc` or `use-std` features) or `heapless::Vec` (with the `heapless` feature).
+//!
+//! [`LeSlice`] borrows a sequence of primitives straight from the input buffer when
+//! deserializing, without copying or allocating.
+//!
+//! These helpers are intended for use with postcard. Other serde formats will see the elements
+//! as a single byte string.
+//!
+//! ## Example
+//!
+//! ```rust
+//! # #[cfg(feature = "heapless")] {
+//! use core::ops::Deref;
+//! use heapless::Vec;
+//! use postcard::{from_bytes, to_vec};
+//! use serde::{Deserialize, Serialize};
+//!
+//! #[derive(Serialize, Deserialize, Debug, PartialEq)]
+//! struct Frame {
+//!     #[serde(with = "postcard::bulk")]
+//!     samples: Vec<u16, 8>,
+//!     #[serde(with = "postcard::bulk::array")]
+//!     gains: [f32; 2],
+//! }
+//!
+//! let mut samples = Vec::new();
+//! samples.extend_from_slice(&[0x0102, 0x0304]).unwrap();
+//! let frame = Frame { samples, gains: [1.0, 0.5] };
+//!
+//! let output: Vec<u8, 32> = to_vec(&frame).unwrap();
+//! assert_eq!(
+//!     &[0x02, 0x02, 0x01, 0x04, 0x03, 0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x00, 0x3F],
+//!     output.deref()
+//! );
+//!
+//! let out: Frame = from_bytes(output.deref()).unwrap();
+//! assert_eq!(out, frame);
+//! # }
+//! ```
+
+use core::fmt;
+use core::marker::PhantomData;
+use serde::de::{self, Deserialize, Deserializer, Visitor};
+use serde::ser::{Serialize, Serializer};
+
+#[cfg(any(feature = "alloc", feature = "use-std"))]
+extern crate alloc;
+
+mod sealed {
+    pub trait Sealed {}
+}
+
+/// A fixed-width primitive that can be copied in bulk. This trait is sealed.
+pub trait Primitive: sealed::Sealed + Copy + Default {
+    #[doc(hidden)]
+    const SEQ_NAME: &'static str;
+
+    #[doc(hidden)]
+    const ARRAY_NAME: &'static str;
+
+    #[doc(hidden)]
+    fn from_le_slice(bytes: &[u8]) -> Self;
+}
+
+macro_rules! impl_primitive {
+    ($($ty:ty => $width:literal),* $(,)?) => {
+        $(
+            impl sealed::Sealed for $ty {}
+
+            impl Primitive for $ty {
+                const SEQ_NAME: &'static str = concat!("$postcard::bulk::seq", $width);
+                const ARRAY_NAME: &'static str = concat!("$postcard::bulk::array", $width);
+
+                #[inline(always)]
+                fn from_le_slice(bytes: &[u8]) -> Self {
+                    let mut buf = [0u8; $width];
+                    buf.copy_from_slice(bytes);
+                    <$ty>::from_le_bytes(buf)
+                }
+            }
+        )*
+    };
+}
+
+impl_primitive! {
+    u8 => 1,
+    i8 => 1,
+    u16 => 2,
+    i16 => 2,
+    u32 => 4,
+    i32 => 4,
+    f32 => 4,
+    u64 => 8,
+    i64 => 8,
+    f64 => 8,
+    u128 => 16,
+    i128 => 16,
+}
+
+/// Find the element width and whether a length prefix is used, for the
+/// newtype names used to mark bulk data towards the postcard (de)serializer.
+#[inline]
+pub(crate) fn lookup(name: &str) -> Option<(usize, bool)> {
+    if !name.starts_with('$') {
+        return None;
+    }
+    match name {
+        "$postcard::bulk::seq1" => Some((1, true)),
+        "$postcard::bulk::seq2" => Some((2, true)),
+        "$postcard::bulk::seq4" => Some((4, true)),
+        "$postcard::bulk::seq8" => Some((8, true)),
+        "$postcard::bulk::seq16" => Some((16, true)),
+        "$postcard::bulk::array1" => Some((1, false)),
+        "$postcard::bulk::array2" => Some((2, false)),
+        "$postcard::bulk::array4" => Some((4, false)),
+        "$postcard::bulk::array8" => Some((8, false)),
+        "$postcard::bulk::array16" => Some((16, false)),
+        // Fixed-layout values are a run of bytes, without a length prefix
+        crate::fixed::NAME => Some((1, false)),
+        _ => None,
+    }
+}
+
+/// The elements of a slice, as little-endian bytes.
+struct LeBytes<'a>(&'a [u8]);
+
+#[cfg(target_endian = "little")]
+impl<'a> LeBytes<'a> {
+    fn new<T: Primitive>(data: &'a [T]) -> Self {
+        // SAFETY: `Primitive` types have no padding, and on little-endian targets
+        // their in-memory representation is their serialized representation.
+        LeBytes(unsafe {
+            core::slice::from_raw_parts(data.as_ptr() as *const u8, core::mem::size_of_val(data))
+        })
+    }
+}
+
+impl<'a> Serialize for LeBytes<'a> {
+    fn serialize<S: Serializer>(&self, serializer: S) -> Result<S::Ok, S::Error> {
+        serializer.serialize_bytes(self.0)
+    }
+}
+
+/// Fill `out` from the little-endian `bytes`, which must be exactly as long as `out`.
+fn copy_from_le<T: Primitive>(bytes: &[u8], out: &mut [T]) {
+    debug_assert_eq!(bytes.len(), core::mem::size_of_val(out));
+
+    #[cfg(target_endian = "little")]
+    // SAFETY: `Primitive` types have no padding and every bit pattern is valid,
+    // and the lengths were checked by the caller.
+    unsafe {
+        core::ptr::copy_nonoverlapping(bytes.as_ptr(), out.as_mut_ptr() as *mut u8, bytes.len());
+    }
+
+    #[cfg(not(target_endian = "little"))]
+    for (out, chunk) in out
+        .iter_mut()
+        .zip(bytes.chunks_exact(core::mem::size_of::<T>()))
+    {
+        *out = T::from_le_slice(chunk);
+    }
+}
+
+/// Serialize a sequence of primitives in bulk, for use with `#[serde(with = "postcard::bulk")]`.
+///
+/// On big-endian targets, the elements are serialized one at a time, with the same result.
+pub fn serialize<S, C, T>(data: &C, serializer: S) -> Result<S::Ok, S::Error>
+where
+    S: Serializer,
+    C: AsRef<[T]> + ?Sized,
+    T: Primitive + Serialize,
+{
+    #[cfg(target_endian = "little")]
+    {
+        serializer.serialize_newtype_struct(T::SEQ_NAME, &LeBytes::new(data.as_ref()))
+    }
+
+    #[cfg(not(target_endian = "little"))]
+    {
+        serializer.collect_seq(data.as_ref())
+    }
+}
+
+/// Deserialize a sequence of primitives in bulk, for use with `#[serde(with = "postcard::bulk")]`.
+pub fn deserialize<'de, D, C>(deserializer: D) -> Result<C, D::Error>
+where
+    D: Deserializer<'de>,
+    C: BulkSeq,
+{
+    deserializer.deserialize_newtype_struct(C::Elem::SEQ_NAME, SeqVisitor(PhantomData))
+}
+
+/// A container that a bulk sequence can be deserialized into.
+pub trait BulkSeq: Sized {
+    /// The element type of the container
+    type Elem: Primitive;
+
+    /// Create the container from the little-endian bytes of `len` elements, or
+    /// return `None` if the container cannot hold that many elements.
+    fn from_le_bytes(bytes: &[u8], len: usize) -> Option<Self>;
+}
+
+#[cfg(any(feature = "alloc", feature = "use-std"))]
+impl<T: Primitive> BulkSeq for alloc::vec::Vec<T> {
+    type Elem = T;
+
+    fn from_le_bytes(bytes: &[u8], len: usize) -> Option<Self> {
+        let mut out = alloc::vec![T::default(); len];
+        copy_from_le(bytes, &mut out);
+        Some(out)
+    }
+}
+
+#[cfg(feature = "heapless")]
+impl<T: Primitive, const N: usize> BulkSeq for heapless::Vec<T, N> {
+    type Elem = T;
+
+    fn from_le_bytes(bytes: &[u8], len: usize) -> Option<Self> {
+        let mut out = heapless::Vec::new();
+        out.resize_default(len).ok()?;
+        copy_from_le(bytes, &mut out);
+        Some(out)
+    }
+}
+
+struct SeqVisitor<C>(PhantomData<C>);
+
+impl<'de, C: BulkSeq> Visitor<'de> for SeqVisitor<C> {
+    type Value = C;
+
+    fn expecting(&self, formatter: &mut fmt::Formatter) -> fmt::Result {
+        formatter.write_str("a bulk sequence of primitives")
+    }
+
+    fn visit_bytes<E: de::Error>(self, v: &[u8]) -> Result<C, E> {
+        let width = core::mem::size_of::<C::Elem>();
+        if v.len() % width != 0 {
+            return Err(E::invalid_length(v.len(), &self));
+        }
+        let len = v.len() / width;
+        C::from_le_bytes(v, len).ok_or_else(|| E::invalid_length(len, &self))
+    }
+
+    fn visit_newtype_struct<D: Deserializer<'de>>(self, deserializer: D) -> Result<C, D::Error> {
+        deserializer.deserialize_bytes(self)
+    }
+}
+
+/// A borrowed view of a sequence of primitives, stored as little-endian bytes.
+///
+/// `LeSlice` uses the same wire format as `Vec<T>`, and deserializes without copying by
+/// borrowing the element data from the input buffer, the same way `&[u8]` and `&str` do.
+/// Elements can be read individually regardless of alignment, or the whole sequence can
+/// be viewed as a `&[T]` when the host is little-endian and the data happens to be
+/// suitably aligned.
+///
+/// ```rust
+/// use postcard::{bulk::LeSlice, from_bytes};
+///
+/// let data = [0x02, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00];
+/// let samples: LeSlice<u32> = from_bytes(&data).unwrap();
+///
+/// assert_eq!(samples.len(), 2);
+/// assert_eq!(samples.get(1), Some(0x0001_0000));
+/// assert_eq!(samples.iter().sum::<u32>(), 0x0001_0001);
+/// ```
+pub struct LeSlice<'a, T: Primitive> {
+    bytes: &'a [u8],
+    _elem: PhantomData<T>,
+}
+
+impl<'a, T: Primitive> LeSlice<'a, T> {
+    /// Create a view of the little-endian encoded elements in `bytes`. Returns `None`
+    /// if `bytes` does not contain a whole number of elements.
+    pub fn from_le_bytes(bytes: &'a [u8]) -> Option<Self> {
+        if bytes.len() % core::mem::size_of::<T>() != 0 {
+            return None;
+        }
+        Some(LeSlice {
+            bytes,
+            _elem: PhantomData,
+        })
+    }
+
+    /// Create a view of the given elements. Only available on little-endian targets.
+    #[cfg(target_endian = "little")]
+    pub fn new(data: &'a [T]) -> Self {
+        LeSlice {
+            bytes: LeBytes::new(data).0,
+            _elem: PhantomData,
+        }
+    }
+
+    /// The number of elements
+    pub fn len(&self) -> usize {
+        self.bytes.len() / core::mem::size_of::<T>()
+    }
+
+    /// Whether there are no elements
+    pub fn is_empty(&self) -> bool {
+        self.bytes.is_empty()
+    }
+
+    /// Read the element at `idx`, if it is in bounds
+    pub fn get(&self, idx: usize) -> Option<T> {
+        let width = core::mem::size_of::<T>();
+        let start = idx.checked_mul(width)?;
+        self.bytes
+            .get(start..start.checked_add(width)?)
+            .map(T::from_le_slice)
+    }
+
+    /// Iterate over the elements by value
+    pub fn iter(&self) -> LeSliceIter<'a, T> {
+        LeSliceIter {
+            chunks: self.bytes.chunks_exact(core::mem::size_of::<T>()),
+            _elem: PhantomData,
+        }
+    }
+
+    /// The little-endian encoded elements
+    pub fn as_le_bytes(&self) -> &'a [u8] {
+        self.bytes
+    }
+
+    /// View the elements as a `&[T]` without copying. Returns `None` on big-endian
+    /// targets, or when the data is not aligned for `T`.
+    pub fn as_slice(&self) -> Option<&'a [T]> {
+        #[cfg(target_endian = "little")]
+        {
+            if (self.bytes.as_ptr() as usize) % core::mem::align_of::<T>() == 0 {
+                // SAFETY: the pointer is aligned, the length is a whole number of
+                // elements, and every bit pattern is a valid `Primitive`.
+                return Some(unsafe {
+                    core::slice::from_raw_parts(self.bytes.as_ptr() as *const T, self.len())
+                });
+            }
+        }
+        None
+    }
+
+    /// The elements as a `&[T]` when possible (see [`as_slice`](Self::as_slice)),
+    /// otherwise an owned copy.
+    #[cfg(any(feature = "alloc", feature = "use-std"))]
+    pub fn to_cow(&self) -> alloc::borrow::Cow<'a, [T]> {
+        match self.as_slice() {
+            Some(slice) => alloc::borrow::Cow::Borrowed(slice),
+            None => {
+                let mut out = alloc::vec![T::default(); self.len()];
+                copy_from_le(self.bytes, &mut out);
+                alloc::borrow::Cow::Owned(out)
+            }
+        }
+    }
+}
+
+impl<'a, T: Primitive> Clone for LeSlice<'a, T> {
+    fn clone(&self) -> Self {
+        *self
+    }
+}
+
+impl<'a, T: Primitive> Copy for LeSlice<'a, T> {}
+
+impl<'a, T: Primitive + fmt::Debug> fmt::Debug for LeSlice<'a, T> {
+    fn fmt(&self, f: &mut fmt::Formatter) -> fmt::Result {
+        f.debug_list().entries(self.iter()).finish()
+    }
+}
+
+impl<'a, 'b, T: Primitive + PartialEq> PartialEq<LeSlice<'b, T>> for LeSlice<'a, T> {
+    fn eq(&self, other: &LeSlice<'b, T>) -> bool {
+        self.iter().eq(other.iter())
+    }
+}
+
+impl<'a, T: Primitive> Serialize for LeSlice<'a, T> {
+    fn serialize<S: Serializer>(&self, serializer: S) -> Result<S::Ok, S::Error> {
+        serializer.serialize_newtype_struct(T::SEQ_NAME, &LeBytes(self.bytes))
+    }
+}
+
+impl<'de: 'a, 'a, T: Primitive> Deserialize<'de> for LeSlice<'a, T> {
+    fn deserialize<D: Deserializer<'de>>(deserializer: D) -> Result<Self, D::Error> {
+        deserializer.deserialize_newtype_struct(T::SEQ_NAME, LeSliceVisitor(PhantomData))
+    }
+}
+
+struct LeSliceVisitor<'a, T>(PhantomData<(&'a [u8], T)>);
+
+impl<'de: 'a, 'a, T: Primitive> Visitor<'de> for LeSliceVisitor<'a, T> {
+    type Value = LeSlice<'a, T>;
+
+    fn expecting(&self, formatter: &mut fmt::Formatter) -> fmt::Result {
+        formatter.write_str("a borrowed bulk sequence of primitives")
+    }
+
+    fn visit_borrowed_bytes<E: de::Error>(self, v: &'de [u8]) -> Result<Self::Value, E> {
+        LeSlice::from_le_bytes(v).ok_or_else(|| E::invalid_length(v.len(), &self))
+    }
+
+    fn visit_newtype_struct<D: Deserializer<'de>>(
+        self,
+        deserializer: D,
+    ) -> Result<Self::Value, D::Error> {
+        deserializer.deserialize_bytes(self)
+    }
+}
+
+/// Iterator over the elements of a [`LeSlice`], by value
+pub struct LeSliceIter<'a, T: Primitive> {
+    chunks: core::slice::ChunksExact<'a, u8>,
+    _elem: PhantomData<T>,
+}
+
+impl<'a, T: Primitive> Iterator for LeSliceIter<'a, T> {
+    type Item = T;
+
+    #[inline]
+    fn next(&mut self) -> Option<T> {
+        self.chunks.next().map(T::from_le_slice)
+    }
+
+    fn size_hint(&self) -> (usize, Option<usize>) {
+        self.chunks.size_hint()
+    }
+}
+
+impl<'a, T: Primitive> DoubleEndedIterator for LeSliceIter<'a, T> {
+    #[inline]
+    fn next_back(&mut self) -> Option<T> {
+        self.chunks.next_back().map(T::from_le_slice)
+    }
+}
+
+impl<'a, T: Primitive> ExactSizeIterator for LeSliceIter<'a, T> {}
+
+/// Bulk (de)serialization of arrays of primitives, for use with
+/// `#[serde(with = "postcard::bulk::array")]`.
+///
+/// Like plain arrays, these are serialized without a length prefix.
+pub mod array {
+    use super::*;
+
+    /// Serialize an array of primitives in bulk.
+    ///
+    /// On big-endian targets, the elements are serialized one at a time, with the same result.
+    pub fn serialize<S, T, const N: usize>(data: &[T; N], serializer: S) -> Result<S::Ok, S::Error>
+    where
+        S: Serializer,
+        T: Primitive + Serialize,
+    {
+        #[cfg(target_endian = "little")]
+        {
+            serializer.serialize_newtype_struct(T::ARRAY_NAME, &LeBytes::new(&data[..]))
+        }
+
+        #[cfg(not(target_endian = "little"))]
+        {
+            use serde::ser::SerializeTuple;
+            let mut tup = serializer.serialize_tuple(N)?;
+            for elem in data.iter() {
+                tup.serialize_element(elem)?;
+            }
+            tup.end()
+        }
+    }
+
+    /// Deserialize an array of primitives in bulk.
+    pub fn deserialize<'de, D, T, const N: usize>(deserializer: D) -> Result<[T; N], D::Error>
+    where
+        D: Deserializer<'de>,
+        T: Primitive,
+    {
+        deserializer.deserialize_tuple_struct(T::ARRAY_NAME, N, ArrayVisitor(PhantomData))
+    }
+
+    struct ArrayVisitor<T, const N: usize>(PhantomData<T>);
+
+    impl<'de, T: Primitive, const N: usize> Visitor<'de> for ArrayVisitor<T, N> {
+        type Value = [T; N];
+
+        fn expecting(&self, formatter: &mut fmt::Formatter) -> fmt::Result {
+            write!(formatter, "a bulk array of {} primitives", N)
+        }
+
+        fn visit_bytes<E: de::Error>(self, v: &[u8]) -> Result<[T; N], E> {
+            if v.len() != N * core::mem::size_of::<T>() {
+                return Err(E::invalid_length(v.len(), &self));
+            }
+            let mut out = [T::default(); N];
+            copy_from_le(v, &mut out);
+            Ok(out)
+        }
+    }
+}
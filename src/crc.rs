@@ -0,0 +1,357 @@
+//! # CRC Algorithms
+//!
+//! Checksum algorithms for use with the [`Crc`](crate::flavors::Crc) flavor, and
+//! [`from_bytes_crc`](crate::from_bytes_crc) on the receiving side.
+//!
+//! All algorithms process eight bytes at a time using "slicing-by-8" lookup tables, which
+//! are computed at compile time. When the target has CRC instructions enabled at compile
+//! time, they are used instead of the tables:
+//!
+//! * `x86_64` with the `sse4.2` target feature, for [`Crc32c`]
+//! * `aarch64` with the `crc` target feature, for [`Crc32`] and [`Crc32c`]
+//!
+//! e.g. with `RUSTFLAGS="-C target-feature=+sse4.2"`, or a `target-cpu` that supports them.
+
+/// A CRC algorithm, computed incrementally over a message.
+///
+/// The checksum is appended to the message in little endian byte order.
+pub trait CrcAlgorithm: Default {
+    /// The checksum, as it is stored on the wire
+    type Bytes: AsRef<[u8]>;
+
+    /// Process the next bytes of the message
+    fn update(&mut self, data: &[u8]);
+
+    /// The checksum of all bytes processed so far
+    fn finish(&self) -> Self::Bytes;
+}
+
+/// CRC-16/CCITT-FALSE: polynomial `0x1021`, initial value `0xFFFF`, not reflected, no final
+/// XOR. The checksum of `b"123456789"` is `0x29B1`.
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub struct Crc16Ccitt(u16);
+
+/// CRC-32 (ISO-HDLC), as used by Ethernet, zlib and PNG: polynomial `0x04C11DB7`, reflected.
+/// The checksum of `b"123456789"` is `0xCBF43926`.
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub struct Crc32(u32);
+
+/// CRC-32C (Castagnoli), as used by iSCSI and ext4: polynomial `0x1EDC6F41`, reflected.
+/// The checksum of `b"123456789"` is `0xE3069283`.
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub struct Crc32c(u32);
+
+impl Default for Crc16Ccitt {
+    fn default() -> Self {
+        Crc16Ccitt(0xFFFF)
+    }
+}
+
+impl CrcAlgorithm for Crc16Ccitt {
+    type Bytes = [u8; 2];
+
+    fn update(&mut self, data: &[u8]) {
+        self.0 = update_msb_first(self.0, &CRC16_CCITT_TABLES, data);
+    }
+
+    fn finish(&self) -> [u8; 2] {
+        self.0.to_le_bytes()
+    }
+}
+
+impl Default for Crc32 {
+    fn default() -> Self {
+        Crc32(!0)
+    }
+}
+
+impl CrcAlgorithm for Crc32 {
+    type Bytes = [u8; 4];
+
+    #[cfg(not(all(target_arch = "aarch64", target_feature = "crc")))]
+    fn update(&mut self, data: &[u8]) {
+        self.0 = update_reflected(self.0, &CRC32_TABLES, data);
+    }
+
+    #[cfg(all(target_arch = "aarch64", target_feature = "crc"))]
+    fn update(&mut self, data: &[u8]) {
+        use core::arch::aarch64::{__crc32b, __crc32d};
+        // SAFETY: the `crc` target feature is enabled at compile time
+        self.0 = unsafe { update_hw(self.0, data, |c, w| __crc32d(c, w), |c, b| __crc32b(c, b)) };
+    }
+
+    fn finish(&self) -> [u8; 4] {
+        (!self.0).to_le_bytes()
+    }
+}
+
+impl Default for Crc32c {
+    fn default() -> Self {
+        Crc32c(!0)
+    }
+}
+
+impl CrcAlgorithm for Crc32c {
+    type Bytes = [u8; 4];
+
+    #[cfg(not(any(
+        all(target_arch = "x86_64", target_feature = "sse4.2"),
+        all(target_arch = "aarch64", target_feature = "crc")
+    )))]
+    fn update(&mut self, data: &[u8]) {
+        self.0 = update_reflected(self.0, &CRC32C_TABLES, data);
+    }
+
+    #[cfg(all(target_arch = "x86_64", target_feature = "sse4.2"))]
+    fn update(&mut self, data: &[u8]) {
+        use core::arch::x86_64::{_mm_crc32_u64, _mm_crc32_u8};
+        // SAFETY: the `sse4.2` target feature is enabled at compile time
+        self.0 = unsafe {
+            update_hw(
+                self.0,
+                data,
+                |c, w| _mm_crc32_u64(u64::from(c), w) as u32,
+                |c, b| _mm_crc32_u8(c, b),
+            )
+        };
+    }
+
+    #[cfg(all(target_arch = "aarch64", target_feature = "crc"))]
+    fn update(&mut self, data: &[u8]) {
+        use core::arch::aarch64::{__crc32cb, __crc32cd};
+        // SAFETY: the `crc` target feature is enabled at compile time
+        self.0 = unsafe { update_hw(self.0, data, |c, w| __crc32cd(c, w), |c, b| __crc32cb(c, b)) };
+    }
+
+    fn finish(&self) -> [u8; 4] {
+        (!self.0).to_le_bytes()
+    }
+}
+
+static CRC16_CCITT_TABLES: [[u16; 256]; 8] = msb_first_tables(0x1021);
+#[cfg(not(all(target_arch = "aarch64", target_feature = "crc")))]
+static CRC32_TABLES: [[u32; 256]; 8] = reflected_tables(0xEDB8_8320);
+#[cfg(not(any(
+    all(target_arch = "x86_64", target_feature = "sse4.2"),
+    all(target_arch = "aarch64", target_feature = "crc")
+)))]
+static CRC32C_TABLES: [[u32; 256]; 8] = reflected_tables(0x82F6_3B78);
+
+/// Slicing-by-8 tables for a reflected 32-bit CRC. `tables[k][x]` is the CRC of byte `x`
+/// followed by `k` zero bytes.
+const fn reflected_tables(poly: u32) -> [[u32; 256]; 8] {
+    let mut tables = [[0u32; 256]; 8];
+    let mut i = 0;
+    while i < 256 {
+        let mut crc = i as u32;
+        let mut bit = 0;
+        while bit < 8 {
+            crc = if crc & 1 != 0 {
+                (crc >> 1) ^ poly
+            } else {
+                crc >> 1
+            };
+            bit += 1;
+        }
+        tables[0][i] = crc;
+        i += 1;
+    }
+
+    let mut k = 1;
+    while k < 8 {
+        let mut i = 0;
+        while i < 256 {
+            let prev = tables[k - 1][i];
+            tables[k][i] = (prev >> 8) ^ tables[0][(prev & 0xFF) as usize];
+            i += 1;
+        }
+        k += 1;
+    }
+    tables
+}
+
+/// Slicing-by-8 tables for a non-reflected 16-bit CRC. `tables[k][x]` is the CRC of byte
+/// `x` followed by `k` zero bytes.
+const fn msb_first_tables(poly: u16) -> [[u16; 256]; 8] {
+    let mut tables = [[0u16; 256]; 8];
+    let mut i = 0;
+    while i < 256 {
+        let mut crc = (i as u16) << 8;
+        let mut bit = 0;
+        while bit < 8 {
+            crc = if crc & 0x8000 != 0 {
+                (crc << 1) ^ poly
+            } else {
+                crc << 1
+            };
+            bit += 1;
+        }
+        tables[0][i] = crc;
+        i += 1;
+    }
+
+    let mut k = 1;
+    while k < 8 {
+        let mut i = 0;
+        while i < 256 {
+            let prev = tables[k - 1][i];
+            tables[k][i] = (prev << 8) ^ tables[0][(prev >> 8) as usize];
+            i += 1;
+        }
+        k += 1;
+    }
+    tables
+}
+
+#[cfg(not(all(target_arch = "aarch64", target_feature = "crc")))]
+fn update_reflected(mut crc: u32, tables: &[[u32; 256]; 8], data: &[u8]) -> u32 {
+    let mut chunks = data.chunks_exact(8);
+    for c in &mut chunks {
+        let low = crc ^ u32::from_le_bytes([c[0], c[1], c[2], c[3]]);
+        crc = tables[7][(low & 0xFF) as usize]
+            ^ tables[6][((low >> 8) & 0xFF) as usize]
+            ^ tables[5][((low >> 16) & 0xFF) as usize]
+            ^ tables[4][(low >> 24) as usize]
+            ^ tables[3][c[4] as usize]
+            ^ tables[2][c[5] as usize]
+            ^ tables[1][c[6] as usize]
+            ^ tables[0][c[7] as usize];
+    }
+    for &byte in chunks.remainder() {
+        crc = (crc >> 8) ^ tables[0][((crc ^ u32::from(byte)) & 0xFF) as usize];
+    }
+    crc
+}
+
+fn update_msb_first(mut crc: u16, tables: &[[u16; 256]; 8], data: &[u8]) -> u16 {
+    let mut chunks = data.chunks_exact(8);
+    for c in &mut chunks {
+        crc = tables[7][(c[0] ^ (crc >> 8) as u8) as usize]
+            ^ tables[6][(c[1] ^ crc as u8) as usize]
+            ^ tables[5][c[2] as usize]
+            ^ tables[4][c[3] as usize]
+            ^ tables[3][c[4] as usize]
+            ^ tables[2][c[5] as usize]
+            ^ tables[1][c[6] as usize]
+            ^ tables[0][c[7] as usize];
+    }
+    for &byte in chunks.remainder() {
+        crc = (crc << 8) ^ tables[0][(byte ^ (crc >> 8) as u8) as usize];
+    }
+    crc
+}
+
+/// Drive a CRC instruction over `data`, eight bytes at a time.
+#[cfg(any(
+    all(target_arch = "x86_64", target_feature = "sse4.2"),
+    all(target_arch = "aarch64", target_feature = "crc")
+))]
+#[inline(always)]
+fn update_hw(
+    mut crc: u32,
+    data: &[u8],
+    word: impl Fn(u32, u64) -> u32,
+    byte: impl Fn(u32, u8) -> u32,
+) -> u32 {
+    let mut chunks = data.chunks_exact(8);
+    for c in &mut chunks {
+        let mut buf = [0u8; 8];
+        buf.copy_from_slice(c);
+        crc = word(crc, u64::from_le_bytes(buf));
+    }
+    for &b in chunks.remainder() {
+        crc = byte(crc, b);
+    }
+    crc
+}
+
+#[cfg(test)]
+mod test {
+    use super::*;
+
+    const CHECK: &[u8] = b"123456789";
+
+    /// Bit-at-a-time reference implementation of a reflected 32-bit CRC
+    fn reference_reflected(poly: u32, data: &[u8]) -> u32 {
+        let mut crc = !0u32;
+        for &byte in data {
+            crc ^= u32::from(byte);
+            for _ in 0..8 {
+                crc = if crc & 1 != 0 {
+                    (crc >> 1) ^ poly
+                } else {
+                    crc >> 1
+                };
+            }
+        }
+        !crc
+    }
+
+    /// Bit-at-a-time reference implementation of CRC-16/CCITT-FALSE
+    fn reference_ccitt(data: &[u8]) -> u16 {
+        let mut crc = 0xFFFFu16;
+        for &byte in data {
+            crc ^= u16::from(byte) << 8;
+            for _ in 0..8 {
+                crc = if crc & 0x8000 != 0 {
+                    (crc << 1) ^ 0x1021
+                } else {
+                    crc << 1
+                };
+            }
+        }
+        crc
+    }
+
+    fn checksum<C: CrcAlgorithm>(data: &[u8]) -> C::Bytes {
+        let mut crc = C::default();
+        crc.update(data);
+        crc.finish()
+    }
+
+    fn split_checksum<C: CrcAlgorithm>(head: &[u8], tail: &[u8]) -> C::Bytes {
+        let mut crc = C::default();
+        crc.update(head);
+        crc.update(tail);
+        crc.finish()
+    }
+
+    #[test]
+    fn check_values() {
+        assert_eq!(checksum::<Crc16Ccitt>(CHECK), 0x29B1u16.to_le_bytes());
+        assert_eq!(checksum::<Crc32>(CHECK), 0xCBF4_3926u32.to_le_bytes());
+        assert_eq!(checksum::<Crc32c>(CHECK), 0xE306_9283u32.to_le_bytes());
+    }
+
+    #[test]
+    fn matches_reference() {
+        let mut data = [0u8; 300];
+        for (i, byte) in data.iter_mut().enumerate() {
+            *byte = (i * 167 + 13) as u8;
+        }
+
+        for len in 0..data.len() {
+            let data = &data[..len];
+            assert_eq!(
+                checksum::<Crc16Ccitt>(data),
+                reference_ccitt(data).to_le_bytes()
+            );
+            assert_eq!(
+                checksum::<Crc32>(data),
+                reference_reflected(0xEDB8_8320, data).to_le_bytes()
+            );
+            assert_eq!(
+                checksum::<Crc32c>(data),
+                reference_reflected(0x82F6_3B78, data).to_le_bytes()
+            );
+
+            // Incremental updates, split at every possible point
+            for split in 0..=len {
+                let (head, tail) = data.split_at(split);
+                assert_eq!(split_checksum::<Crc16Ccitt>(head, tail), checksum::<Crc16Ccitt>(data));
+                assert_eq!(split_checksum::<Crc32>(head, tail), checksum::<Crc32>(data));
+                assert_eq!(split_checksum::<Crc32c>(head, tail), checksum::<Crc32c>(data));
+            }
+        }
+    }
+}
@@ -0,0 +1,107 @@
+//! In-place COBS decoding, tuned for large frames.
+
+use crate::scan::find_zero;
+
+/// Blocks shorter than this are copied byte by byte, as a call to `copy_within`
+/// costs more than it saves for them.
+const SHORT_BLOCK: usize = 16;
+
+/// The outcome of decoding one COBS frame in place
+pub(crate) struct Decoded {
+    /// Number of decoded bytes, at the start of the buffer
+    pub(crate) dst_used: usize,
+    /// Number of encoded bytes consumed, including the `0x00` terminator if present
+    pub(crate) src_used: usize,
+}
+
+/// Decode the first COBS frame in `buf` in place.
+///
+/// The frame ends at the first `0x00` byte, or at the end of the buffer. The terminator
+/// is located with a word-at-a-time scan, and every block of non-zero bytes is then
+/// moved to its decoded position with a single `copy_within`. Short blocks use a plain
+/// byte loop, like `cobs::decode_in_place`, which this is a drop-in replacement for.
+pub(crate) fn decode_in_place(buf: &mut [u8]) -> Result<Decoded, ()> {
+    let end = find_zero(buf).unwrap_or(buf.len());
+    let mut src = 0;
+    let mut dst = 0;
+
+    while src < end {
+        // Never zero, as `end` is the first zero byte
+        let code = usize::from(buf[src]);
+        let block_end = src + code;
+        if block_end > end {
+            return Err(());
+        }
+
+        let len = code - 1;
+        if len < SHORT_BLOCK {
+            for i in 1..code {
+                buf[dst + i - 1] = buf[src + i];
+            }
+        } else {
+            buf.copy_within(src + 1..block_end, dst);
+        }
+        dst += len;
+        src = block_end;
+
+        // A full block does not imply a zero byte after it
+        if code != 0xFF && src < end {
+            buf[dst] = 0;
+            dst += 1;
+        }
+    }
+
+    Ok(Decoded {
+        dst_used: dst,
+        src_used: (end + 1).min(buf.len()),
+    })
+}
+
+#[cfg(test)]
+mod test {
+    use super::decode_in_place;
+
+    #[test]
+    fn matches_reference_decoder() {
+        let mut data = [0u8; 1500];
+        let mut encoded = [0u8; 1600];
+        for zero_every in &[0usize, 1, 2, 5, 17, 253, 254, 255, 256, 600] {
+            for len in &[0usize, 1, 15, 16, 17, 253, 254, 255, 508, 1500] {
+                for (i, byte) in data.iter_mut().enumerate() {
+                    *byte = if *zero_every != 0 && i % zero_every == 0 {
+                        0
+                    } else {
+                        (i % 255) as u8 + 1
+                    };
+                }
+                let sz = cobs::encode(&data[..*len], &mut encoded);
+                encoded[sz] = 0;
+                encoded[sz + 1] = 0xAA;
+
+                let mut reference = encoded;
+                let ref_sz = cobs::decode_in_place(&mut reference[..sz + 2]).unwrap();
+
+                let mut ours = encoded;
+                let decoded = decode_in_place(&mut ours[..sz + 2]).unwrap();
+
+                assert_eq!(decoded.dst_used, ref_sz);
+                assert_eq!(decoded.dst_used, *len);
+                assert_eq!(decoded.src_used, sz + 1);
+                assert_eq!(&ours[..*len], &data[..*len]);
+
+                // Without a terminator the whole buffer is consumed
+                let mut ours = encoded;
+                let decoded = decode_in_place(&mut ours[..sz]).unwrap();
+                assert_eq!(decoded.src_used, sz);
+                assert_eq!(&ours[..*len], &data[..*len]);
+            }
+        }
+    }
+
+    #[test]
+    fn rejects_truncated_blocks() {
+        assert!(decode_in_place(&mut [0x05, 0x01, 0x02, 0x00]).is_err());
+        assert!(decode_in_place(&mut [0x03, 0x01]).is_err());
+        assert!(decode_in_place(&mut [0xFF, 0x01, 0x00]).is_err());
+    }
+}
@@ -6,6 +6,8 @@ use serde::de::{
     // EnumAccess, MapAccess, VariantAccess
 };
 
+use crate::bulk;
+use crate::de::utf8;
 use crate::error::{Error, Result};
 use crate::varint::VarintUsize;
 
@@ -17,16 +19,60 @@ pub struct Deserializer<'de> {
     // This string starts with the input data and characters are truncated off
     // the beginning as data is parsed.
     pub(crate) input: &'de [u8],
+    // Set by `from_bytes_trusted`, see `Deserializer::trusted`
+    trusted: bool,
 }
 
 impl<'de> Deserializer<'de> {
     /// Obtain a Deserializer from a slice of bytes
     pub fn from_bytes(input: &'de [u8]) -> Self {
-        Deserializer { input }
+        Deserializer {
+            input,
+            trusted: false,
+        }
+    }
+
+    /// Obtain a Deserializer from a slice of bytes that is known to hold well-formed
+    /// postcard messages, such as data this program serialized and stored itself.
+    ///
+    /// Checks that only guard against malformed input are skipped in release builds: strings
+    /// are not validated as UTF-8, and any non-zero `bool` or `Option` tag is taken as `true`
+    /// or `Some`. Bounds checks are kept, so truncated input is still reported as
+    /// [`Error::DeserializeUnexpectedEnd`]. Builds with `debug_assertions` enabled perform
+    /// every check, as [`Deserializer::from_bytes`] does.
+    ///
+    /// # Safety
+    ///
+    /// Every message read from `input` must have been produced by postcard serializing a
+    /// value of the type it is deserialized as. Otherwise, strings that are not valid UTF-8
+    /// may be handed to the visitor, which is undefined behavior.
+    pub unsafe fn from_bytes_trusted(input: &'de [u8]) -> Self {
+        Deserializer {
+            input,
+            trusted: true,
+        }
     }
 }
 
 impl<'de> Deserializer<'de> {
+    /// Whether per-field validation is skipped, see [`Deserializer::from_bytes_trusted`]
+    #[inline(always)]
+    fn trusted(&self) -> bool {
+        self.trusted && !cfg!(debug_assertions)
+    }
+
+    /// Take a string of `ct` bytes, returning `bad_utf8` if it is not valid UTF-8
+    fn try_take_str(&mut self, ct: usize, bad_utf8: Error) -> Result<&'de str> {
+        let bytes = self.try_take_n(ct)?;
+        if self.trusted() {
+            // SAFETY: the caller of `from_bytes_trusted` guarantees that the input is
+            // well-formed, which includes the UTF-8 encoding of strings
+            Ok(unsafe { core::str::from_utf8_unchecked(bytes) })
+        } else {
+            utf8::from_utf8(bytes).map_err(|_| bad_utf8)
+        }
+    }
+
     fn try_take_n(&mut self, ct: usize) -> Result<&'de [u8]> {
         if self.input.len() >= ct {
             let (a, b) = self.input.split_at(ct);
@@ -37,7 +83,37 @@ impl<'de> Deserializer<'de> {
         }
     }
 
-    fn try_take_varint(&mut self) -> Result<usize> {
+    /// Take a varint from the input.
+    ///
+    /// When at least eight bytes remain, the varint is decoded from a single little
+    /// endian load: the terminating byte is the lowest byte without its continuation
+    /// bit set, and the 7-bit groups are then packed together with a few shift and
+    /// mask operations. Longer varints and short inputs use the byte-wise loop.
+    pub(crate) fn try_take_varint(&mut self) -> Result<usize> {
+        if let Some(&byte) = self.input.first() {
+            if (byte & 0x80) == 0 {
+                self.input = &self.input[1..];
+                return Ok(byte as usize);
+            }
+        }
+
+        if self.input.len() >= 8 {
+            let mut buf = [0u8; 8];
+            buf.copy_from_slice(&self.input[..8]);
+            let word = u64::from_le_bytes(buf);
+
+            let stops = !word & 0x8080_8080_8080_8080;
+            if stops != 0 {
+                let len = (stops.trailing_zeros() / 8) as usize + 1;
+                if len > VarintUsize::varint_usize_max() {
+                    return Err(Error::DeserializeBadVarint);
+                }
+                self.input = &self.input[len..];
+                let used = word & (u64::max_value() >> (64 - 8 * len));
+                return Ok(pack_varint_groups(used) as usize);
+            }
+        }
+
         for i in 0..VarintUsize::varint_usize_max() {
             let val = self.input.get(i).ok_or(Error::DeserializeUnexpectedEnd)?;
             if (val & 0x80) == 0 {
@@ -56,6 +132,26 @@ impl<'de> Deserializer<'de> {
     }
 }
 
+/// Pack the low 7 bits of each byte of a little endian word into a contiguous value.
+/// Bytes beyond the end of the varint must already be cleared.
+#[inline(always)]
+#[cfg(not(all(target_arch = "x86_64", target_feature = "bmi2")))]
+fn pack_varint_groups(word: u64) -> u64 {
+    let x = word & 0x7F7F_7F7F_7F7F_7F7F;
+    let x = ((x & 0x7F00_7F00_7F00_7F00) >> 1) | (x & 0x007F_007F_007F_007F);
+    let x = ((x & 0x3FFF_0000_3FFF_0000) >> 2) | (x & 0x0000_3FFF_0000_3FFF);
+    ((x & 0x0FFF_FFFF_0000_0000) >> 4) | (x & 0x0000_0000_0FFF_FFFF)
+}
+
+/// Pack the low 7 bits of each byte of a little endian word into a contiguous value.
+/// Bytes beyond the end of the varint must already be cleared.
+#[inline(always)]
+#[cfg(all(target_arch = "x86_64", target_feature = "bmi2"))]
+fn pack_varint_groups(word: u64) -> u64 {
+    // SAFETY: the `bmi2` target feature is enabled at compile time
+    unsafe { core::arch::x86_64::_pext_u64(word, 0x7F7F_7F7F_7F7F_7F7F) }
+}
+
 struct SeqAccess<'a, 'b: 'a> {
     deserializer: &'a mut Deserializer<'b>,
     len: usize,
@@ -134,6 +230,7 @@ impl<'de, 'a> de::Deserializer<'de> for &'a mut Deserializer<'de> {
         let val = match self.try_take_n(1)?[0] {
             0 => false,
             1 => true,
+            _ if self.trusted() => true,
             _ => return Err(Error::DeserializeBadBool),
         };
         visitor.visit_bool(val)
@@ -255,13 +352,12 @@ impl<'de, 'a> de::Deserializer<'de> for &'a mut Deserializer<'de> {
         if sz > 4 {
             return Err(Error::DeserializeBadChar);
         }
-        let bytes: &'de [u8] = self.try_take_n(sz)?;
         // we pass the character through string conversion because
         // this handles transforming the array of code units to a 
         // codepoint. we can't use char::from_u32() because it expects
         // an already-processed codepoint.
-        let character = core::str::from_utf8(&bytes)
-            .map_err(|_| Error::DeserializeBadChar)?
+        let character = self
+            .try_take_str(sz, Error::DeserializeBadChar)?
             .chars()
             .next()
             .ok_or(Error::DeserializeBadChar)?;
@@ -273,8 +369,7 @@ impl<'de, 'a> de::Deserializer<'de> for &'a mut Deserializer<'de> {
         V: Visitor<'de>,
     {
         let sz = self.try_take_varint()?;
-        let bytes: &'de [u8] = self.try_take_n(sz)?;
-        let str_sl = core::str::from_utf8(bytes).map_err(|_| Error::DeserializeBadUtf8)?;
+        let str_sl = self.try_take_str(sz, Error::DeserializeBadUtf8)?;
 
         visitor.visit_borrowed_str(str_sl)
     }
@@ -309,6 +404,7 @@ impl<'de, 'a> de::Deserializer<'de> for &'a mut Deserializer<'de> {
         match self.try_take_n(1)?[0] {
             0 => visitor.visit_none(),
             1 => visitor.visit_some(self),
+            _ if self.trusted() => visitor.visit_some(self),
             _ => Err(Error::DeserializeBadOption),
         }
     }
@@ -331,10 +427,16 @@ impl<'de, 'a> de::Deserializer<'de> for &'a mut Deserializer<'de> {
         self.deserialize_unit(visitor)
     }
 
-    fn deserialize_newtype_struct<V>(self, _name: &'static str, visitor: V) -> Result<V::Value>
+    fn deserialize_newtype_struct<V>(self, name: &'static str, visitor: V) -> Result<V::Value>
     where
         V: Visitor<'de>,
     {
+        // Bulk sequences lend all of their elements' bytes at once
+        if let Some((width, true)) = bulk::lookup(name) {
+            let len = self.try_take_varint()?;
+            let sz = len.checked_mul(width).ok_or(Error::DeserializeUnexpectedEnd)?;
+            return visitor.visit_borrowed_bytes(self.try_take_n(sz)?);
+        }
         visitor.visit_newtype_struct(self)
     }
 
@@ -362,13 +464,18 @@ impl<'de, 'a> de::Deserializer<'de> for &'a mut Deserializer<'de> {
 
     fn deserialize_tuple_struct<V>(
         self,
-        _name: &'static str,
+        name: &'static str,
         len: usize,
         visitor: V,
     ) -> Result<V::Value>
     where
         V: Visitor<'de>,
     {
+        // Bulk arrays lend all of their elements' bytes at once
+        if let Some((width, false)) = bulk::lookup(name) {
+            let sz = len.checked_mul(width).ok_or(Error::DeserializeUnexpectedEnd)?;
+            return visitor.visit_borrowed_bytes(self.try_take_n(sz)?);
+        }
         self.deserialize_tuple(len, visitor)
     }
 
@@ -459,7 +566,9 @@ impl<'de, 'a> serde::de::EnumAccess<'de> for &'a mut Deserializer<'de> {
         if varint > 0xFFFF_FFFF {
             return Err(Error::DeserializeBadEnum);
         }
-        let v = DeserializeSeed::deserialize(seed, (varint as u32).into_deserializer())?;
+        // The seed only fails for a discriminant that does not match any variant
+        let v = DeserializeSeed::deserialize(seed, (varint as u32).into_deserializer())
+            .map_err(|_: Error| Error::DeserializeBadEnum)?;
         Ok((v, self))
     }
 }
@@ -0,0 +1,138 @@
+use core::iter::FusedIterator;
+use core::marker::PhantomData;
+
+use serde::Deserialize;
+
+use crate::de::deserializer::Deserializer;
+use crate::de::from_bytes_cobs;
+use crate::error::{Error, Result};
+use crate::scan::find_zero;
+
+/// An iterator over back-to-back messages of type `T` in a byte slice, created by
+/// [`iter_from_bytes`](crate::iter_from_bytes).
+///
+/// Each item is the byte offset of the message within the slice, along with the message
+/// itself. A single `Deserializer` is reused for all messages.
+///
+/// Iteration stops without an error when the remaining bytes end in the middle of a
+/// message. Any other error is returned once, after which the iterator is exhausted.
+/// In both cases, the unprocessed bytes are available from
+/// [`remainder`](FromBytesIter::remainder).
+pub struct FromBytesIter<'de, T> {
+    deserializer: Deserializer<'de>,
+    len: usize,
+    done: bool,
+    _t: PhantomData<fn() -> T>,
+}
+
+impl<'de, T> FromBytesIter<'de, T> {
+    pub(crate) fn new(input: &'de [u8]) -> Self {
+        FromBytesIter {
+            deserializer: Deserializer::from_bytes(input),
+            len: input.len(),
+            done: false,
+            _t: PhantomData,
+        }
+    }
+
+    /// The bytes that have not been deserialized yet, such as a truncated message at
+    /// the end of the input
+    pub fn remainder(&self) -> &'de [u8] {
+        self.deserializer.input
+    }
+
+    /// The byte offset of the next message
+    pub fn offset(&self) -> usize {
+        self.len - self.deserializer.input.len()
+    }
+}
+
+impl<'de, T> Iterator for FromBytesIter<'de, T>
+where
+    T: Deserialize<'de>,
+{
+    type Item = Result<(usize, T)>;
+
+    fn next(&mut self) -> Option<Self::Item> {
+        if self.done || self.deserializer.input.is_empty() {
+            return None;
+        }
+
+        let start = self.deserializer.input;
+        let offset = self.offset();
+        match T::deserialize(&mut self.deserializer) {
+            Ok(t) => {
+                // A message that takes no bytes would otherwise be yielded forever
+                self.done = self.deserializer.input.len() == start.len();
+                Some(Ok((offset, t)))
+            }
+            Err(e) => {
+                self.deserializer.input = start;
+                self.done = true;
+                match e {
+                    Error::DeserializeUnexpectedEnd => None,
+                    e => Some(Err(e)),
+                }
+            }
+        }
+    }
+}
+
+impl<'de, T> FusedIterator for FromBytesIter<'de, T> where T: Deserialize<'de> {}
+
+/// An iterator over back-to-back COBS frames of type `T` in a byte slice, created by
+/// [`iter_from_bytes_cobs`](crate::iter_from_bytes_cobs).
+///
+/// Each item is the byte offset of the frame within the slice, along with the message
+/// itself. Frames are decoded in place as the iterator advances.
+///
+/// A frame that fails to decode is returned as an error, and iteration continues with
+/// the next frame. Iteration stops when no terminated frame remains, leaving the
+/// unterminated tail (if any) in [`remainder`](FromBytesCobsIter::remainder).
+pub struct FromBytesCobsIter<'de, T> {
+    rest: &'de mut [u8],
+    offset: usize,
+    _t: PhantomData<fn() -> T>,
+}
+
+impl<'de, T> FromBytesCobsIter<'de, T> {
+    pub(crate) fn new(input: &'de mut [u8]) -> Self {
+        FromBytesCobsIter {
+            rest: input,
+            offset: 0,
+            _t: PhantomData,
+        }
+    }
+
+    /// The bytes that have not been decoded yet, such as an unterminated frame at the
+    /// end of the input
+    pub fn remainder(&self) -> &[u8] {
+        self.rest
+    }
+
+    /// The byte offset of the next frame
+    pub fn offset(&self) -> usize {
+        self.offset
+    }
+}
+
+impl<'de, T> Iterator for FromBytesCobsIter<'de, T>
+where
+    T: Deserialize<'de>,
+{
+    type Item = Result<(usize, T)>;
+
+    fn next(&mut self) -> Option<Self::Item> {
+        // Frames are only decoded once their terminator has been found, as decoding
+        // in place would otherwise destroy a truncated tail
+        let end = find_zero(self.rest)? + 1;
+        let (frame, rest) = core::mem::take(&mut self.rest).split_at_mut(end);
+        self.rest = rest;
+
+        let offset = self.offset;
+        self.offset += end;
+        Some(from_bytes_cobs::<T>(frame).map(|t| (offset, t)))
+    }
+}
+
+impl<'de, T> FusedIterator for FromBytesCobsIter<'de, T> where T: Deserialize<'de> {}
@@ -1,9 +1,17 @@
-use cobs::decode_in_place;
 use serde::Deserialize;
 
+pub(crate) mod cobs_decode;
 pub(crate) mod deserializer;
+pub(crate) mod iter;
+pub(crate) mod utf8;
 
+use cobs_decode::decode_in_place;
+use iter::{FromBytesCobsIter, FromBytesIter};
+
+use crate::arena::{Arena, DeserializeIn};
+use crate::crc::CrcAlgorithm;
 use crate::error::{Error, Result};
+use crate::ser::flavors::LengthHeader;
 use deserializer::Deserializer;
 
 /// Deserialize a message of type `T` from a byte slice. The unused portion (if any)
@@ -17,29 +25,156 @@ where
     Ok(t)
 }
 
+/// Deserialize a message of type `T` from a byte slice known to hold a well-formed
+/// message, skipping checks that only guard against malformed input. The unused portion
+/// (if any) of the byte slice is not returned.
+///
+/// See [`Deserializer::from_bytes_trusted`] for which checks are skipped.
+///
+/// # Safety
+///
+/// `s` must start with a message produced by postcard serializing a value of type `T`,
+/// for example data this program stored itself behind a CRC that has been checked.
+pub unsafe fn from_bytes_trusted<'a, T>(s: &'a [u8]) -> Result<T>
+where
+    T: Deserialize<'a>,
+{
+    let mut deserializer = Deserializer::from_bytes_trusted(s);
+    let t = T::deserialize(&mut deserializer)?;
+    Ok(t)
+}
+
+/// Deserialize a message of type `T` from the start of a byte slice, discard it, and return
+/// the number of bytes the message takes.
+///
+/// This is exactly `take_from_bytes::<T>(s)` with the value dropped, and costs the same:
+/// the full value is built, including any allocations for owned fields such as `String`
+/// or `Vec`. It is useful to find the length of a well-formed frame before forwarding its
+/// raw bytes. See [`take_from_bytes`] for deserializing against types that borrow from the
+/// input, which do not allocate.
+///
+/// ```rust
+/// use postcard::{validate, Error};
+///
+/// // `(&str, bool)`, followed by the start of the next message
+/// let data = [0x02, b'h', b'i', 0x01, 0xAA];
+/// assert_eq!(validate::<(&str, bool)>(&data), Ok(4));
+///
+/// // Not a bool
+/// assert_eq!(
+///     validate::<(&str, bool)>(&[0x02, b'h', b'i', 0x02]),
+///     Err(Error::DeserializeBadBool)
+/// );
+/// ```
+pub fn validate<'a, T>(s: &'a [u8]) -> Result<usize>
+where
+    T: Deserialize<'a>,
+{
+    take_from_bytes::<T>(s).map(|(_, rest)| s.len() - rest.len())
+}
+
+/// Deserialize a message of type `T` from a byte slice into an existing value, reusing
+/// its allocations where possible. The unused portion (if any) of the byte slice is not
+/// returned.
+///
+/// This uses serde's `Deserialize::deserialize_in_place`: a `Vec` or `String` in `place`
+/// keeps its capacity, and the elements of a `Vec` are themselves deserialized in place.
+/// Structs need to be derived with the `deserialize_in_place` feature of `serde_derive`
+/// enabled to be deserialized field by field, otherwise they are replaced as a whole.
+///
+/// If an error is returned, `place` is left in a valid but unspecified state.
+///
+/// ```rust
+/// # #[cfg(any(feature = "alloc", feature = "use-std"))] {
+/// use postcard::from_bytes_in_place;
+/// extern crate alloc;
+/// use alloc::{string::String, vec::Vec};
+///
+/// let mut names: Vec<String> = Vec::with_capacity(8);
+/// from_bytes_in_place(&[0x02, 0x01, b'a', 0x02, b'b', b'c'], &mut names).unwrap();
+/// assert_eq!(names, &["a", "bc"]);
+///
+/// from_bytes_in_place(&[0x01, 0x03, b'd', b'e', b'f'], &mut names).unwrap();
+/// assert_eq!(names, &["def"]);
+/// assert_eq!(names.capacity(), 8);
+/// # }
+/// ```
+pub fn from_bytes_in_place<'a, T>(s: &'a [u8], place: &mut T) -> Result<()>
+where
+    T: Deserialize<'a>,
+{
+    let mut deserializer = Deserializer::from_bytes(s);
+    T::deserialize_in_place(&mut deserializer, place)
+}
+
+/// Deserialize a message of type `T` from a cobs-encoded byte slice into an existing
+/// value, reusing its allocations where possible. The unused portion (if any) of the
+/// byte slice is not returned.
+///
+/// See [`from_bytes_in_place`] for details.
+pub fn from_bytes_cobs_in_place<'a, T>(s: &'a mut [u8], place: &mut T) -> Result<()>
+where
+    T: Deserialize<'a>,
+{
+    let sz = decode_in_place(s)
+        .map_err(|_| Error::DeserializeBadEncoding)?
+        .dst_used;
+    from_bytes_in_place::<T>(&s[..sz], place)
+}
+
+/// Deserialize a message of type `T` from a byte slice, placing its strings, byte buffers
+/// and vectors in the given arena. The unused portion (if any) of the byte slice is not
+/// returned.
+///
+/// `T` does not borrow from `s`. If the arena runs out of space,
+/// `Error::DeserializeArenaFull` is returned. See the [`arena`](crate::arena) module for
+/// more information.
+pub fn from_bytes_in<'a, T>(s: &[u8], arena: &Arena<'a>) -> Result<T>
+where
+    T: DeserializeIn<'a>,
+{
+    arena.reset_exhausted();
+    let mut deserializer = Deserializer::from_bytes(s);
+    T::deserialize_in(&mut deserializer, arena).map_err(|e| {
+        if arena.exhausted() {
+            Error::DeserializeArenaFull
+        } else {
+            e
+        }
+    })
+}
+
 /// Deserialize a message of type `T` from a cobs-encoded byte slice. The
 /// unused portion (if any) of the byte slice is not returned.
 pub fn from_bytes_cobs<'a, T>(s: &'a mut [u8]) -> Result<T>
 where
     T: Deserialize<'a>,
 {
-    let sz = decode_in_place(s).map_err(|_| Error::DeserializeBadEncoding)?;
+    let sz = decode_in_place(s)
+        .map_err(|_| Error::DeserializeBadEncoding)?
+        .dst_used;
     from_bytes::<T>(&s[..sz])
 }
 
 /// Deserialize a message of type `T` from a cobs-encoded byte slice. The
-/// unused portion (if any) of the byte slice is returned for further usage
+/// unused portion (if any) of the byte slice is returned for further usage,
+/// starting right after the `0x00` terminator of the decoded frame
 pub fn take_from_bytes_cobs<'a, T>(s: &'a mut [u8]) -> Result<(T, &'a mut [u8])>
 where
     T: Deserialize<'a>,
 {
-    let sz = decode_in_place(s).map_err(|_| Error::DeserializeBadEncoding)?;
-    let (used, unused) = s.split_at_mut(sz);
-    Ok((from_bytes::<T>(used)?, unused))
+    let decoded = decode_in_place(s).map_err(|_| Error::DeserializeBadEncoding)?;
+    let (used, unused) = s.split_at_mut(decoded.src_used);
+    Ok((from_bytes::<T>(&used[..decoded.dst_used])?, unused))
 }
 
 /// Deserialize a message of type `T` from a byte slice. The unused portion (if any)
 /// of the byte slice is returned for further usage
+///
+/// Owned fields such as `String` or `Vec` are allocated. Deserializing into a type with
+/// the same layout that borrows from the input instead, e.g. `&str` for `String`, `&[u8]`
+/// for `Vec<u8>`, or [`LeSlice`](crate::bulk::LeSlice) for vectors of numbers, checks the
+/// same encoding without allocating.
 pub fn take_from_bytes<'a, T>(s: &'a [u8]) -> Result<(T, &'a [u8])>
 where
     T: Deserialize<'a>,
@@ -49,13 +184,120 @@ where
     Ok((t, deserializer.input))
 }
 
+/// Deserialize a message of type `T` from a byte slice, preceded by its length as
+/// described by `header`, as written by the
+/// [`LengthPrefixed`](crate::flavors::LengthPrefixed) flavor. The unused portion (if any)
+/// of the byte slice after the message is returned for further usage.
+///
+/// Varint headers are accepted both padded and in their shortest form.
+pub fn take_from_bytes_length_prefixed<'a, T>(
+    s: &'a [u8],
+    header: LengthHeader,
+) -> Result<(T, &'a [u8])>
+where
+    T: Deserialize<'a>,
+{
+    let (len, body) = match header {
+        LengthHeader::U16 | LengthHeader::U32 => {
+            if s.len() < header.size() {
+                return Err(Error::DeserializeUnexpectedEnd);
+            }
+            let (bytes, body) = s.split_at(header.size());
+            let mut buf = [0u8; 4];
+            buf[..bytes.len()].copy_from_slice(bytes);
+            (u32::from_le_bytes(buf) as usize, body)
+        }
+        LengthHeader::Varint(_) => {
+            let mut deserializer = Deserializer::from_bytes(s);
+            let len = deserializer.try_take_varint()?;
+            (len, deserializer.input)
+        }
+    };
+
+    if body.len() < len {
+        return Err(Error::DeserializeUnexpectedEnd);
+    }
+    let (msg, rest) = body.split_at(len);
+    Ok((from_bytes(msg)?, rest))
+}
+
+/// Deserialize a message of type `T` from a byte slice, followed by a checksum computed
+/// with the CRC algorithm `C`, as written by [`to_slice_crc`](crate::to_slice_crc) or the
+/// [`Crc`](crate::flavors::Crc) flavor. The unused portion (if any) after the checksum
+/// is not returned.
+///
+/// The checksum covers exactly the bytes consumed by deserializing `T`, and a mismatch
+/// is reported as `Error::DeserializeBadCrc`.
+///
+/// The checksum is not computed while decoding: `T` is deserialized first, and the
+/// consumed bytes are then checksummed in a single pass, while they are still in cache.
+/// A corrupted message may therefore be reported as a deserialization error instead of
+/// `Error::DeserializeBadCrc`, and `T` is fully deserialized before the checksum is
+/// checked.
+pub fn from_bytes_crc<'a, T, C>(s: &'a [u8]) -> Result<T>
+where
+    T: Deserialize<'a>,
+    C: CrcAlgorithm,
+{
+    let mut deserializer = Deserializer::from_bytes(s);
+    let t = T::deserialize(&mut deserializer)?;
+    let (msg, rest) = s.split_at(s.len() - deserializer.input.len());
+
+    let mut crc = C::default();
+    crc.update(msg);
+    let expected = crc.finish();
+    let expected = expected.as_ref();
+    match rest.get(..expected.len()) {
+        Some(found) if found == expected => Ok(t),
+        Some(_) => Err(Error::DeserializeBadCrc),
+        None => Err(Error::DeserializeUnexpectedEnd),
+    }
+}
+
+/// Lazily deserialize back-to-back messages of type `T` from a byte slice.
+///
+/// The returned iterator yields the byte offset of each message along with the message,
+/// and stops at the end of the slice, or at a truncated message at the end of it.
+///
+/// ```rust
+/// use postcard::iter_from_bytes;
+///
+/// // Three `u16`s, and the first byte of a fourth one
+/// let data = [0x01, 0x00, 0x02, 0x00, 0x03, 0x00, 0x04];
+///
+/// let mut iter = iter_from_bytes::<u16>(&data);
+/// assert_eq!(iter.next(), Some(Ok((0, 1))));
+/// assert_eq!(iter.next(), Some(Ok((2, 2))));
+/// assert_eq!(iter.next(), Some(Ok((4, 3))));
+/// assert_eq!(iter.next(), None);
+/// assert_eq!(iter.remainder(), &[0x04]);
+/// ```
+pub fn iter_from_bytes<'a, T>(s: &'a [u8]) -> FromBytesIter<'a, T>
+where
+    T: Deserialize<'a>,
+{
+    FromBytesIter::new(s)
+}
+
+/// Lazily deserialize back-to-back cobs-encoded messages of type `T` from a byte slice.
+///
+/// The returned iterator yields the byte offset of each frame along with the message,
+/// and stops at the end of the slice, or at an unterminated frame at the end of it.
+/// Each frame is decoded in place, as with [`take_from_bytes_cobs`].
+pub fn iter_from_bytes_cobs<'a, T>(s: &'a mut [u8]) -> FromBytesCobsIter<'a, T>
+where
+    T: Deserialize<'a>,
+{
+    FromBytesCobsIter::new(s)
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 #[cfg(feature = "heapless")]
 #[cfg(test)]
 mod test_heapless {
     use super::*;
-    use crate::ser::to_vec;
+    use crate::ser::{to_vec, to_vec_cobs};
     use core::fmt::Write;
     use core::ops::Deref;
     use heapless::{String, Vec, FnvIndexMap};
@@ -198,6 +440,41 @@ mod test_heapless {
         assert_eq!(input.deref(), de.deref());
     }
 
+    #[test]
+    fn varints() {
+        use crate::varint::VarintUsize;
+
+        let mut buf = VarintUsize::new_buf();
+        let mut val = 1usize;
+        while val != 0 {
+            for probe in &[val - 1, val, val | (val >> 1)] {
+                let used = VarintUsize(*probe).to_buf(&mut buf);
+
+                // Exactly sized input uses the byte-wise path for short inputs
+                let mut de = deserializer::Deserializer::from_bytes(used);
+                assert_eq!(de.try_take_varint().unwrap(), *probe);
+                assert!(de.input.is_empty());
+
+                // Trailing data allows the single load path
+                let mut padded: Vec<u8, 32> = Vec::new();
+                padded.extend_from_slice(used).unwrap();
+                padded.extend_from_slice(&[0xFF; 16]).unwrap();
+                let mut de = deserializer::Deserializer::from_bytes(padded.deref());
+                assert_eq!(de.try_take_varint().unwrap(), *probe);
+                assert_eq!(de.input, &[0xFF; 16]);
+            }
+            val <<= 1;
+        }
+
+        let unterminated = [0xFFu8; 16];
+        let mut de = deserializer::Deserializer::from_bytes(&unterminated);
+        assert_eq!(de.try_take_varint(), Err(Error::DeserializeBadVarint));
+
+        let truncated = [0xFFu8; 3];
+        let mut de = deserializer::Deserializer::from_bytes(&truncated);
+        assert_eq!(de.try_take_varint(), Err(Error::DeserializeUnexpectedEnd));
+    }
+
     #[allow(dead_code)]
     #[derive(Serialize, Deserialize, Debug, Eq, PartialEq)]
     enum BasicEnum {
@@ -345,6 +622,162 @@ mod test_heapless {
         assert_eq!(out, ByteSliceStruct { bytes: &[0u8; 32] });
     }
 
+    #[derive(Serialize, Deserialize, Debug, PartialEq)]
+    struct PlainFrame {
+        seq: u8,
+        samples: Vec<u32, 64>,
+        gains: [f64; 3],
+        tail: i16,
+    }
+
+    #[derive(Serialize, Deserialize, Debug, PartialEq)]
+    struct BulkFrame {
+        seq: u8,
+        #[serde(with = "crate::bulk")]
+        samples: Vec<u32, 64>,
+        #[serde(with = "crate::bulk::array")]
+        gains: [f64; 3],
+        tail: i16,
+    }
+
+    #[test]
+    fn bulk() {
+        let mut samples: Vec<u32, 64> = Vec::new();
+        for i in 0..40 {
+            samples.push(0x0102_0304 * i).unwrap();
+        }
+        let plain = PlainFrame {
+            seq: 7,
+            samples: samples.clone(),
+            gains: [1.0, -0.5, 1e-9],
+            tail: -2,
+        };
+        let bulk = BulkFrame {
+            seq: 7,
+            samples,
+            gains: [1.0, -0.5, 1e-9],
+            tail: -2,
+        };
+
+        // Identical wire format in both directions
+        let plain_out: Vec<u8, 256> = to_vec(&plain).unwrap();
+        let bulk_out: Vec<u8, 256> = to_vec(&bulk).unwrap();
+        assert_eq!(plain_out, bulk_out);
+        assert_eq!(bulk_out.len(), 1 + 1 + 160 + 24 + 2);
+
+        let out: BulkFrame = from_bytes(plain_out.deref()).unwrap();
+        assert_eq!(out, bulk);
+        let out: PlainFrame = from_bytes(bulk_out.deref()).unwrap();
+        assert_eq!(out, plain);
+
+        // Truncated element data
+        assert_eq!(
+            from_bytes::<BulkFrame>(&bulk_out[..100]),
+            Err(Error::DeserializeUnexpectedEnd)
+        );
+
+        // More elements than the destination can hold: `seq`, 65 complete `u32`s, then
+        // `gains` and `tail`
+        let mut long: Vec<u8, 512> = Vec::new();
+        long.extend_from_slice(&[0x00, 65]).unwrap();
+        long.extend_from_slice(&[0xAA; 65 * 4]).unwrap();
+        long.extend_from_slice(&[0x00; 24 + 2]).unwrap();
+        assert_eq!(
+            from_bytes::<BulkFrame>(long.deref()),
+            Err(Error::SerdeDeCustom)
+        );
+        // One element less fits
+        long[1] = 64;
+        assert!(from_bytes::<BulkFrame>(&long[..long.len() - 4]).is_ok());
+        long[1] = 65;
+        // The same input with the last element cut short
+        assert_eq!(
+            from_bytes::<BulkFrame>(&long[..2 + 65 * 4 - 1]),
+            Err(Error::DeserializeUnexpectedEnd)
+        );
+    }
+
+    #[derive(Serialize, Deserialize, Debug, PartialEq)]
+    struct BulkBytes {
+        #[serde(with = "crate::bulk")]
+        payload: Vec<u8, 64>,
+        #[serde(with = "crate::bulk::array")]
+        key: [u8; 4],
+        #[serde(with = "crate::bulk")]
+        offsets: Vec<i8, 4>,
+    }
+
+    #[test]
+    fn bulk_bytes() {
+        let mut payload: Vec<u8, 64> = Vec::new();
+        payload.extend_from_slice(&[0xA5; 40]).unwrap();
+        let mut offsets: Vec<i8, 4> = Vec::new();
+        offsets.extend_from_slice(&[-1, 1]).unwrap();
+        let plain = (payload.clone(), [1u8, 2, 3, 4], offsets.clone());
+        let bulk = BulkBytes {
+            payload,
+            key: [1, 2, 3, 4],
+            offsets,
+        };
+
+        let plain_out: Vec<u8, 128> = to_vec(&plain).unwrap();
+        let bulk_out: Vec<u8, 128> = to_vec(&bulk).unwrap();
+        assert_eq!(plain_out, bulk_out);
+        assert_eq!(bulk_out.len(), 1 + 40 + 4 + 1 + 2);
+
+        let out: BulkBytes = from_bytes(plain_out.deref()).unwrap();
+        assert_eq!(out, bulk);
+        assert_eq!(
+            from_bytes::<BulkBytes>(&bulk_out[..44]),
+            Err(Error::DeserializeUnexpectedEnd)
+        );
+    }
+
+    #[derive(Serialize, Deserialize, Debug, PartialEq)]
+    struct Waveform<'a> {
+        channel: u8,
+        #[serde(borrow)]
+        samples: crate::bulk::LeSlice<'a, i16>,
+    }
+
+    #[test]
+    fn borrowed_bulk() {
+        let mut samples: Vec<i16, 64> = Vec::new();
+        for i in 0..50 {
+            samples.push(i * -300).unwrap();
+        }
+        let output: Vec<u8, 128> = to_vec(&(3u8, &samples)).unwrap();
+
+        let out: Waveform = from_bytes(output.deref()).unwrap();
+        assert_eq!(out.channel, 3);
+        assert_eq!(out.samples.len(), 50);
+        assert!(out.samples.iter().eq(samples.iter().cloned()));
+        assert_eq!(out.samples.get(49), Some(49 * -300));
+        assert_eq!(out.samples.get(50), None);
+
+        // The element data is borrowed from the input, not copied
+        assert_eq!(out.samples.as_le_bytes().as_ptr(), output[2..].as_ptr());
+
+        let reser: Vec<u8, 128> = to_vec(&out).unwrap();
+        assert_eq!(reser, output);
+    }
+
+    #[test]
+    fn borrowed_bulk_alignment() {
+        let words = [0x0403_0201u32, 0x0807_0605, 0x0C0B_0A09];
+        let view = crate::bulk::LeSlice::<u32>::new(&words);
+        assert_eq!(view.as_slice(), Some(&words[..]));
+
+        // Shifting by one byte breaks alignment, but elements can still be read
+        let bytes = view.as_le_bytes();
+        let shifted = crate::bulk::LeSlice::<u16>::from_le_bytes(&bytes[1..5]).unwrap();
+        assert_eq!(shifted.as_slice(), None);
+        assert_eq!(shifted.get(0), Some(0x0302));
+        assert_eq!(shifted.get(1), Some(0x0504));
+
+        assert!(crate::bulk::LeSlice::<u32>::from_le_bytes(&bytes[..5]).is_none());
+    }
+
     #[test]
     fn chars() {
         let x: char = 'a';
@@ -464,4 +897,277 @@ mod test_heapless {
 
         assert_eq!(input, out);
     }
+
+    #[test]
+    fn take_cobs_frames() {
+        let mut stream: Vec<u8, 32> = Vec::new();
+        stream.extend_from_slice(&to_vec_cobs::<_, 16>(&0x1234u16).unwrap()).unwrap();
+        stream.extend_from_slice(&to_vec_cobs::<_, 16>(&[0u8, 7, 0]).unwrap()).unwrap();
+
+        let (first, rest) = take_from_bytes_cobs::<u16>(&mut stream).unwrap();
+        assert_eq!(first, 0x1234);
+        let (second, rest) = take_from_bytes_cobs::<[u8; 3]>(rest).unwrap();
+        assert_eq!(second, [0, 7, 0]);
+        assert!(rest.is_empty());
+    }
+
+    #[test]
+    fn crc() {
+        use crate::crc::{Crc16Ccitt, Crc32, Crc32c};
+        use crate::flavors::{Cobs, Crc, HVec};
+        use crate::serialize_with_flavor;
+
+        let input = RefStruct {
+            bytes: &[0x01, 0x00, 0x02, 0x20],
+            str_s: "hElLo",
+        };
+
+        let mut buf = [0u8; 32];
+        let used = crate::to_slice_crc::<_, Crc32>(&input, &mut buf).unwrap();
+        assert_eq!(used.len(), 15);
+        assert_eq!(from_bytes_crc::<RefStruct, Crc32>(used).unwrap(), input);
+        assert_eq!(
+            from_bytes_crc::<RefStruct, Crc32c>(used),
+            Err(Error::DeserializeBadCrc)
+        );
+        assert_eq!(
+            from_bytes_crc::<RefStruct, Crc32>(&used[..14]),
+            Err(Error::DeserializeUnexpectedEnd)
+        );
+        used[3] ^= 0x10;
+        assert_eq!(
+            from_bytes_crc::<RefStruct, Crc32>(used),
+            Err(Error::DeserializeBadCrc)
+        );
+
+        // The checksum is COBS encoded along with the message
+        let mut framed: Vec<u8, 32> =
+            serialize_with_flavor::<_, Crc<Cobs<HVec<32>>, Crc16Ccitt>, _>(
+                &input,
+                Crc::new(Cobs::try_new(HVec::default()).unwrap()),
+            )
+            .unwrap();
+        let sz = cobs_decode::decode_in_place(&mut framed).unwrap().dst_used;
+        assert_eq!(sz, 13);
+        let out = from_bytes_crc::<RefStruct, Crc16Ccitt>(&framed[..sz]).unwrap();
+        assert_eq!(out, input);
+    }
+
+    #[test]
+    fn length_prefixed() {
+        use crate::flavors::{HVec, LengthPrefixed};
+        use crate::serialize_with_flavor;
+
+        let input = RefStruct {
+            bytes: &[0x01, 0x00, 0x02, 0x20],
+            str_s: "hElLo",
+        };
+
+        for &(header, expected) in &[
+            (LengthHeader::U16, &[0x0B, 0x00][..]),
+            (LengthHeader::U32, &[0x0B, 0x00, 0x00, 0x00][..]),
+            (LengthHeader::Varint(100), &[0x0B][..]),
+            (LengthHeader::Varint(1000), &[0x8B, 0x00][..]),
+        ] {
+            let mut stream: Vec<u8, 64> = Vec::new();
+            for _ in 0..2 {
+                let framed: Vec<u8, 32> = serialize_with_flavor::<_, LengthPrefixed<HVec<32>>, _>(
+                    &input,
+                    LengthPrefixed::try_new(HVec::default(), header).unwrap(),
+                )
+                .unwrap();
+                assert_eq!(&framed[..header.size()], expected);
+                assert_eq!(&framed[header.size()..], to_vec::<_, 32>(&input).unwrap().deref());
+                stream.extend_from_slice(&framed).unwrap();
+            }
+
+            let (first, rest) =
+                take_from_bytes_length_prefixed::<RefStruct>(&stream, header).unwrap();
+            assert_eq!(first, input);
+            let (second, rest) =
+                take_from_bytes_length_prefixed::<RefStruct>(rest, header).unwrap();
+            assert_eq!(second, input);
+            assert!(rest.is_empty());
+
+            assert_eq!(
+                take_from_bytes_length_prefixed::<RefStruct>(&stream[..header.size() + 10], header),
+                Err(Error::DeserializeUnexpectedEnd)
+            );
+        }
+
+        // The message does not fit the header
+        let res = serialize_with_flavor::<_, LengthPrefixed<HVec<256>>, _>(
+            &[0x55u8; 200][..],
+            LengthPrefixed::try_new(HVec::default(), LengthHeader::Varint(127)).unwrap(),
+        );
+        assert_eq!(res, Err(Error::SerializeBufferFull));
+    }
+
+    #[test]
+    fn arena() {
+        use crate::arena::{Arena, ArenaBytes, ArenaStr, ArenaVec};
+
+        type Names<'a> = ArenaVec<'a, ArenaStr<'a>>;
+
+        let mut storage = [0u8; 128];
+        let arena = Arena::new(&mut storage);
+        let (names, body) = {
+            let names: &[&str] = &["hElLo", "", "wOrLd"];
+            let input: Vec<u8, 32> = to_vec(&(names, Some(&[1u8, 2, 3][..]))).unwrap();
+            let names: Names = from_bytes_in(&input, &arena).unwrap();
+            let body: Option<ArenaBytes> = from_bytes_in(&input[14..], &arena).unwrap();
+            (names, body)
+        };
+
+        assert_eq!(names, ["hElLo", "", "wOrLd"]);
+        assert_eq!(body.unwrap(), [1, 2, 3]);
+        // Three `ArenaStr`s, followed by their contents and the body
+        let used = arena.used();
+        assert!(used >= 3 * core::mem::size_of::<ArenaStr>() + 10 + 3);
+
+        let input: Vec<u8, 64> = to_vec(&["x"; 20][..]).unwrap();
+        assert_eq!(
+            from_bytes_in::<Names>(&input, &arena),
+            Err(Error::DeserializeArenaFull)
+        );
+        assert_eq!(
+            from_bytes_in::<Names>(&[0x01, 0x01], &arena),
+            Err(Error::DeserializeUnexpectedEnd)
+        );
+    }
+
+    #[cfg(feature = "use-std")]
+    #[test]
+    fn in_place() {
+        extern crate std;
+        use std::string::String;
+        use std::vec::Vec;
+
+        type Msg = (Vec<String>, Vec<u32>, u8);
+
+        let mut place: Msg = (Vec::new(), Vec::new(), 0);
+        let msg: Msg = (
+            vec!["first".into(), "second".into(), "third".into()],
+            vec![1, 2, 3, 4],
+            7,
+        );
+        let mut buf = crate::to_stdvec_cobs(&msg).unwrap();
+        from_bytes_cobs_in_place(&mut buf, &mut place).unwrap();
+        assert_eq!(place, msg);
+
+        let strings = place.0.as_ptr();
+        let first = place.0[0].as_ptr();
+        let numbers = place.1.as_ptr();
+
+        // Shorter sequences and strings reuse the existing allocations
+        let msg: Msg = (vec!["one".into(), "two".into()], vec![5, 6], 8);
+        let buf = crate::to_stdvec(&msg).unwrap();
+        from_bytes_in_place(&buf, &mut place).unwrap();
+        assert_eq!(place, msg);
+        assert_eq!(place.0.as_ptr(), strings);
+        assert_eq!(place.0[0].as_ptr(), first);
+        assert_eq!(place.1.as_ptr(), numbers);
+
+        assert_eq!(
+            from_bytes_in_place(&buf[..buf.len() - 1], &mut place),
+            Err(Error::DeserializeUnexpectedEnd)
+        );
+    }
+
+    #[test]
+    fn trusted() {
+        type Msg<'a> = (&'a str, bool, Option<char>, &'a str);
+        let input: Msg = ("hi", true, Some('ü'), "a longer string, past a single block");
+        let buf: Vec<u8, 64> = to_vec(&input).unwrap();
+
+        let out: Msg = unsafe { from_bytes_trusted(&buf) }.unwrap();
+        assert_eq!(out, input);
+
+        // Bounds are always checked
+        assert_eq!(
+            unsafe { from_bytes_trusted::<Msg>(&buf[..buf.len() - 1]) },
+            Err(Error::DeserializeUnexpectedEnd)
+        );
+
+        // Debug builds keep every check, release builds take any non-zero tag as `true`
+        let mut bad = buf.clone();
+        bad[3] = 0x02;
+        let out = unsafe { from_bytes_trusted::<Msg>(&bad) };
+        if cfg!(debug_assertions) {
+            assert_eq!(out, Err(Error::DeserializeBadBool));
+        } else {
+            assert_eq!(out, Ok(input));
+        }
+    }
+
+    #[test]
+    fn validates() {
+        let input = RefStruct {
+            bytes: &[0x01, 0x00, 0x02, 0x20],
+            str_s: "hElLo",
+        };
+        let mut buf: Vec<u8, 16> = to_vec(&input).unwrap();
+        assert_eq!(validate::<RefStruct>(&buf), Ok(11));
+
+        buf.push(0xFF).unwrap();
+        assert_eq!(validate::<RefStruct>(&buf), Ok(11));
+        assert_eq!(
+            validate::<RefStruct>(&buf[..10]),
+            Err(Error::DeserializeUnexpectedEnd)
+        );
+
+        // Invalid UTF-8 in `str_s`
+        buf[8] = 0xFF;
+        assert_eq!(validate::<RefStruct>(&buf), Err(Error::DeserializeBadUtf8));
+
+        // Unknown enum variant
+        #[allow(dead_code)]
+        #[derive(Deserialize)]
+        enum Small {
+            A,
+            B(u8),
+        }
+        assert_eq!(validate::<Small>(&[0x01, 0x05]), Ok(2));
+        assert_eq!(validate::<Small>(&[0x02]), Err(Error::DeserializeBadEnum));
+        assert_eq!(validate::<Option<Small>>(&[0x02]), Err(Error::DeserializeBadOption));
+    }
+
+    #[test]
+    fn iter_messages() {
+        let mut stream: Vec<u8, 32> = Vec::new();
+        for word in &[0x10u32, 0x2000, 0x30_0000] {
+            stream.extend_from_slice(&to_vec::<_, 8>(&(*word, true)).unwrap()).unwrap();
+        }
+        stream.extend_from_slice(&[0xFF, 0xFF]).unwrap();
+
+        let mut iter = iter_from_bytes::<(u32, bool)>(&stream);
+        assert_eq!(iter.next(), Some(Ok((0, (0x10, true)))));
+        assert_eq!(iter.next(), Some(Ok((5, (0x2000, true)))));
+        assert_eq!(iter.next(), Some(Ok((10, (0x30_0000, true)))));
+        assert_eq!(iter.next(), None);
+        assert_eq!(iter.remainder(), &[0xFF, 0xFF]);
+
+        // Errors other than a truncated tail are reported, and end the iteration
+        let mut iter = iter_from_bytes::<bool>(&[0x01, 0x02, 0x01]);
+        assert_eq!(iter.next(), Some(Ok((0, true))));
+        assert_eq!(iter.next(), Some(Err(Error::DeserializeBadBool)));
+        assert_eq!(iter.next(), None);
+        assert_eq!(iter.remainder(), &[0x02, 0x01]);
+    }
+
+    #[test]
+    fn iter_cobs_frames() {
+        let mut stream: Vec<u8, 32> = Vec::new();
+        stream.extend_from_slice(&to_vec_cobs::<_, 16>(&0x1234u16).unwrap()).unwrap();
+        stream.extend_from_slice(&[0x05, 0x00]).unwrap();
+        stream.extend_from_slice(&to_vec_cobs::<_, 16>(&0x0056u16).unwrap()).unwrap();
+        stream.extend_from_slice(&[0x02, 0x01]).unwrap();
+
+        let mut iter = iter_from_bytes_cobs::<u16>(&mut stream);
+        assert_eq!(iter.next(), Some(Ok((0, 0x1234))));
+        assert_eq!(iter.next(), Some(Err(Error::DeserializeBadEncoding)));
+        assert_eq!(iter.next(), Some(Ok((6, 0x0056))));
+        assert_eq!(iter.next(), None);
+        assert_eq!(iter.remainder(), &[0x02, 0x01]);
+    }
 }
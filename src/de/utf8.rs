@@ -0,0 +1,146 @@
+//! UTF-8 validation for borrowed strings.
+//!
+//! Without the `simd-utf8` feature this is `core::str::from_utf8`. With it, the input is
+//! checked 32 bytes at a time for ASCII using SSE2 on x86_64, NEON on aarch64, and
+//! word-at-a-time arithmetic elsewhere. Blocks containing non-ASCII bytes are handed to
+//! `core::str::from_utf8`, after which the block scan resumes at the next character
+//! boundary, so mostly-ASCII text stays on the fast path.
+
+/// Validate `bytes` as UTF-8
+#[cfg(not(feature = "simd-utf8"))]
+#[inline]
+pub(crate) fn from_utf8(bytes: &[u8]) -> Result<&str, ()> {
+    core::str::from_utf8(bytes).map_err(|_| ())
+}
+
+/// Validate `bytes` as UTF-8
+#[cfg(feature = "simd-utf8")]
+#[inline]
+pub(crate) fn from_utf8(bytes: &[u8]) -> Result<&str, ()> {
+    if bytes.len() < BLOCK {
+        return core::str::from_utf8(bytes).map_err(|_| ());
+    }
+    validate(bytes)?;
+    // SAFETY: `validate` accepts exactly the inputs that `core::str::from_utf8` accepts
+    Ok(unsafe { core::str::from_utf8_unchecked(bytes) })
+}
+
+#[cfg(feature = "simd-utf8")]
+const BLOCK: usize = 32;
+
+#[cfg(feature = "simd-utf8")]
+fn validate(bytes: &[u8]) -> Result<(), ()> {
+    let mut pos = 0;
+    while bytes.len() - pos >= BLOCK {
+        let block = &bytes[pos..pos + BLOCK];
+        if is_ascii_block(block) {
+            pos += BLOCK;
+            continue;
+        }
+
+        // `pos` is always on a character boundary, as everything before it has been
+        // validated. A character cut off at the end of the block is picked up again by
+        // the next iteration.
+        match core::str::from_utf8(block) {
+            Ok(_) => pos += BLOCK,
+            Err(e) if e.error_len().is_none() => pos += e.valid_up_to(),
+            Err(_) => return Err(()),
+        }
+    }
+
+    core::str::from_utf8(&bytes[pos..]).map(drop).map_err(drop)
+}
+
+/// Whether all 32 bytes of `block` are ASCII
+#[cfg(all(feature = "simd-utf8", target_arch = "x86_64"))]
+#[inline(always)]
+fn is_ascii_block(block: &[u8]) -> bool {
+    use core::arch::x86_64::{__m128i, _mm_loadu_si128, _mm_movemask_epi8, _mm_or_si128};
+
+    debug_assert_eq!(block.len(), BLOCK);
+    let ptr = block.as_ptr() as *const __m128i;
+    // SAFETY: SSE2 is part of the x86_64 baseline, and `block` holds two unaligned
+    // 16 byte loads
+    unsafe {
+        let both = _mm_or_si128(_mm_loadu_si128(ptr), _mm_loadu_si128(ptr.add(1)));
+        _mm_movemask_epi8(both) == 0
+    }
+}
+
+/// Whether all 32 bytes of `block` are ASCII
+#[cfg(all(feature = "simd-utf8", target_arch = "aarch64"))]
+#[inline(always)]
+fn is_ascii_block(block: &[u8]) -> bool {
+    use core::arch::aarch64::{vld1q_u8, vmaxvq_u8, vorrq_u8};
+
+    debug_assert_eq!(block.len(), BLOCK);
+    let ptr = block.as_ptr();
+    // SAFETY: NEON is part of the aarch64 baseline, and `block` holds two 16 byte loads
+    unsafe { vmaxvq_u8(vorrq_u8(vld1q_u8(ptr), vld1q_u8(ptr.add(16)))) < 0x80 }
+}
+
+/// Whether all 32 bytes of `block` are ASCII
+#[cfg(all(
+    feature = "simd-utf8",
+    not(any(target_arch = "x86_64", target_arch = "aarch64"))
+))]
+#[inline(always)]
+fn is_ascii_block(block: &[u8]) -> bool {
+    const HI: u64 = 0x8080_8080_8080_8080;
+
+    let mut acc = 0;
+    for word in block.chunks_exact(8) {
+        let mut buf = [0u8; 8];
+        buf.copy_from_slice(word);
+        acc |= u64::from_ne_bytes(buf);
+    }
+    acc & HI == 0
+}
+
+#[cfg(test)]
+mod test {
+    use super::from_utf8;
+
+    fn check(bytes: &[u8]) {
+        assert_eq!(
+            from_utf8(bytes).ok(),
+            core::str::from_utf8(bytes).ok(),
+            "{:02X?}",
+            bytes
+        );
+    }
+
+    #[test]
+    fn matches_core() {
+        let mut buf = [b'a'; 96];
+
+        // Every one and two byte sequence, and the start of every three and four byte
+        // sequence, at offsets around the block boundaries
+        for &offset in &[0usize, 15, 30, 31, 32, 63, 64, 93] {
+            for a in 0..=0xFFu8 {
+                for b in 0..=0xFFu8 {
+                    for &c in &[b'a', 0x80, 0xBF, 0xC0] {
+                        let mut data = buf;
+                        data[offset] = a;
+                        if offset + 1 < data.len() {
+                            data[offset + 1] = b;
+                        }
+                        if offset + 2 < data.len() {
+                            data[offset + 2] = c;
+                        }
+                        check(&data);
+                        check(&data[..offset + 2]);
+                    }
+                }
+            }
+        }
+
+        // Valid multi-byte characters straddling every block boundary
+        let text = "ascii then ümlauts, 中文, and 🦀 crabs, repeated: ü中🦀ü中🦀ü中🦀ü中🦀";
+        for start in 0..text.len() {
+            check(&text.as_bytes()[start..]);
+        }
+        buf[40] = 0xFF;
+        check(&buf);
+    }
+}
@@ -11,7 +11,7 @@ pub enum Error {
     NotYetImplemented,
     /// The serialize buffer is full
     SerializeBufferFull,
-    /// The length of a sequence must be known
+    /// The length of a sequence must be known, as the flavor cannot back-patch it
     SerializeSeqLengthUnknown,
     /// Hit the end of buffer, expected more data
     DeserializeUnexpectedEnd,
@@ -25,10 +25,17 @@ pub enum Error {
     DeserializeBadUtf8,
     /// Found an Option discriminant that wasn't 0 or 1
     DeserializeBadOption,
-    /// Found an enum discriminant that was > u32::max_value()
+    /// Found an enum discriminant that was > u32::max_value(), or did not match a variant
     DeserializeBadEnum,
     /// The original data was not well encoded
     DeserializeBadEncoding,
+    /// The checksum of the message did not match
+    DeserializeBadCrc,
+    /// The arena does not have enough space left for the message
+    DeserializeArenaFull,
+    /// A `Display` implementation passed to `collect_str` failed, or did not produce the
+    /// same output twice
+    CollectStrError,
     /// Serde Serialization Error
     SerdeSerCustom,
     /// Serde Deserialization Error
@@ -47,7 +54,9 @@ impl Display for Error {
                     "This is a feature that Postcard intends to support, but does not yet"
                 }
                 SerializeBufferFull => "The serialize buffer is full",
-                SerializeSeqLengthUnknown => "The length of a sequence must be known",
+                SerializeSeqLengthUnknown => {
+                    "The length of a sequence must be known for this flavor"
+                }
                 DeserializeUnexpectedEnd => "Hit the end of buffer, expected more data",
                 DeserializeBadVarint => {
                     "Found a varint that didn't terminate. Is the usize too big for this platform?"
@@ -56,8 +65,11 @@ impl Display for Error {
                 DeserializeBadChar => "Found an invalid unicode char",
                 DeserializeBadUtf8 => "Tried to parse invalid utf-8",
                 DeserializeBadOption => "Found an Option discriminant that wasn't 0 or 1",
-                DeserializeBadEnum => "Found an enum discriminant that was > u32::max_value()",
+                DeserializeBadEnum => "Found an enum discriminant that did not match a variant",
                 DeserializeBadEncoding => "The original data was not well encoded",
+                DeserializeBadCrc => "The checksum of the message did not match",
+                DeserializeArenaFull => "The arena does not have enough space left for the message",
+                CollectStrError => "Error while processing `collect_str` during serialization",
                 SerdeSerCustom => "Serde Serialization Error",
                 SerdeDeCustom => "Serde Deserialization Error",
             }
@@ -0,0 +1,337 @@
+//! # Fixed-Layout Types
+//!
+//! A struct made only of fixed-width fields always serializes to the same number of bytes,
+//! at the same offsets. The [`FixedLayout`] trait describes that layout, so that a value can
+//! be read or written as a single run of bytes: one bounds check when deserializing, and one
+//! `try_extend` of the flavor when serializing, instead of one of each per field.
+//!
+//! `FixedLayout` is implemented for integers, floats, `bool` and arrays of `FixedLayout`
+//! types, and can be derived for structs whose fields are all `FixedLayout` with the
+//! `derive` feature. Fields using [`postcard::fixed`](self) are then read and written as
+//! a whole.
+//!
+//! The wire format is unchanged: a field using [`postcard::fixed`](self) is encoded exactly
+//! like the same field without it.
+//!
+//! ```rust
+//! # #[cfg(all(feature = "heapless", feature = "derive"))] {
+//! use core::ops::Deref;
+//! use heapless::Vec;
+//! use postcard::{from_bytes, to_vec, FixedLayout};
+//! use serde::{Deserialize, Serialize};
+//!
+//! #[derive(FixedLayout, Serialize, Deserialize, Debug, PartialEq)]
+//! struct Sample {
+//!     channel: u8,
+//!     value: i16,
+//!     gains: [f32; 2],
+//!     valid: bool,
+//! }
+//!
+//! #[derive(Serialize, Deserialize, Debug, PartialEq)]
+//! struct Report {
+//!     seq: u32,
+//!     #[serde(with = "postcard::fixed")]
+//!     sample: Sample,
+//! }
+//!
+//! assert_eq!(Sample::SIZE, 12);
+//!
+//! let report = Report {
+//!     seq: 1,
+//!     sample: Sample { channel: 2, value: -2, gains: [1.0, 0.5], valid: true },
+//! };
+//! let output: Vec<u8, 32> = to_vec(&report).unwrap();
+//!
+//! // Identical to serializing the sample field by field
+//! let plain: Vec<u8, 32> = to_vec(&(1u32, &report.sample)).unwrap();
+//! assert_eq!(output, plain);
+//!
+//! let out: Report = from_bytes(output.deref()).unwrap();
+//! assert_eq!(out, report);
+//! # }
+//! ```
+//!
+//! These helpers are intended for use with postcard. Other serde formats will see the value
+//! as a single byte string, and accept either a byte string or a sequence of bytes when
+//! deserializing.
+
+use core::fmt;
+use core::marker::PhantomData;
+use core::mem::{size_of, MaybeUninit};
+use core::slice;
+use serde::de::{self, Deserializer, SeqAccess, Visitor};
+use serde::ser::{Serialize, Serializer};
+
+/// The newtype name used to mark fixed-layout data towards the postcard (de)serializer
+pub(crate) const NAME: &str = "$postcard::fixed";
+
+/// A type that always serializes to `SIZE` bytes with the same layout.
+///
+/// This trait is sealed: it is implemented for integers, floats, `bool` and arrays, and can
+/// only be implemented for other types with `#[derive(FixedLayout)]`. The derived encoding
+/// matches that of `Serialize` for structs that also derive `Serialize` and `Deserialize`
+/// without renaming, skipping or flattening fields.
+pub trait FixedLayout: Sized + Sealed {
+    /// The number of bytes any value of this type serializes to
+    const SIZE: usize;
+
+    /// Write the serialized form of `self` to `out`, which is exactly `SIZE` bytes long
+    fn write_le(&self, out: &mut [u8]);
+
+    /// Read a value from `bytes`, which is exactly `SIZE` bytes long. Returns `None` if
+    /// the bytes are not a valid encoding, such as a `bool` that is neither 0 nor 1.
+    fn read_le(bytes: &[u8]) -> Option<Self>;
+
+    #[doc(hidden)]
+    fn serialize_fixed<S: Serializer>(&self, serializer: S) -> Result<S::Ok, S::Error>;
+}
+
+pub(crate) mod sealed {
+    /// Prevents implementations of [`FixedLayout`](super::FixedLayout) other than those of
+    /// this crate and the derive macro, which ensure that `SIZE` is never larger than the
+    /// size of the type in memory
+    pub trait Sealed {}
+}
+
+use sealed::Sealed;
+
+macro_rules! impl_fixed_layout {
+    ($($ty:ty => $width:literal),* $(,)?) => {
+        $(
+            impl Sealed for $ty {}
+
+            impl FixedLayout for $ty {
+                const SIZE: usize = $width;
+
+                #[inline(always)]
+                fn write_le(&self, out: &mut [u8]) {
+                    out.copy_from_slice(&self.to_le_bytes());
+                }
+
+                #[inline(always)]
+                fn read_le(bytes: &[u8]) -> Option<Self> {
+                    let mut buf = [0u8; $width];
+                    buf.copy_from_slice(bytes);
+                    Some(<$ty>::from_le_bytes(buf))
+                }
+
+                #[doc(hidden)]
+                fn serialize_fixed<S: Serializer>(&self, serializer: S) -> Result<S::Ok, S::Error> {
+                    serialize_le_bytes(&self.to_le_bytes(), serializer)
+                }
+            }
+        )*
+    };
+}
+
+impl_fixed_layout! {
+    u8 => 1,
+    i8 => 1,
+    u16 => 2,
+    i16 => 2,
+    u32 => 4,
+    i32 => 4,
+    f32 => 4,
+    u64 => 8,
+    i64 => 8,
+    f64 => 8,
+    u128 => 16,
+    i128 => 16,
+}
+
+impl Sealed for bool {}
+
+impl FixedLayout for bool {
+    const SIZE: usize = 1;
+
+    #[inline(always)]
+    fn write_le(&self, out: &mut [u8]) {
+        out[0] = *self as u8;
+    }
+
+    #[inline(always)]
+    fn read_le(bytes: &[u8]) -> Option<Self> {
+        match bytes[0] {
+            0 => Some(false),
+            1 => Some(true),
+            _ => None,
+        }
+    }
+
+    #[doc(hidden)]
+    fn serialize_fixed<S: Serializer>(&self, serializer: S) -> Result<S::Ok, S::Error> {
+        serialize_le_bytes(&[*self as u8], serializer)
+    }
+}
+
+impl<T: FixedLayout, const N: usize> Sealed for [T; N] {}
+
+// Arrays are serialized as tuples, without a length prefix
+impl<T: FixedLayout + Copy + Default, const N: usize> FixedLayout for [T; N] {
+    const SIZE: usize = T::SIZE * N;
+
+    #[inline]
+    fn write_le(&self, out: &mut [u8]) {
+        for (elem, out) in self.iter().zip(out.chunks_exact_mut(T::SIZE)) {
+            elem.write_le(out);
+        }
+    }
+
+    #[inline]
+    fn read_le(bytes: &[u8]) -> Option<Self> {
+        let mut out = [T::default(); N];
+        for (out, chunk) in out.iter_mut().zip(bytes.chunks_exact(T::SIZE)) {
+            *out = T::read_le(chunk)?;
+        }
+        Some(out)
+    }
+
+    #[doc(hidden)]
+    fn serialize_fixed<S: Serializer>(&self, serializer: S) -> Result<S::Ok, S::Error> {
+        with_buffer::<Self, _>(|buf| {
+            self.write_le(buf);
+            serialize_le_bytes(buf, serializer)
+        })
+    }
+}
+
+/// Call `f` with a zeroed stack buffer of `T::SIZE` bytes.
+///
+/// `T::SIZE` can not be used as an array length in generic code, so the buffer is backed
+/// by a `T` instead, which is at least as large for every implementation of the sealed
+/// `FixedLayout` trait.
+#[inline(always)]
+fn with_buffer<T: FixedLayout, R>(f: impl FnOnce(&mut [u8]) -> R) -> R {
+    let mut storage = MaybeUninit::<T>::zeroed();
+    // SAFETY: every byte of `storage` is initialized by `zeroed`, and `storage` is only
+    // ever accessed as bytes
+    let bytes =
+        unsafe { slice::from_raw_parts_mut(storage.as_mut_ptr() as *mut u8, size_of::<T>()) };
+    f(&mut bytes[..T::SIZE])
+}
+
+struct LeBytes<'a>(&'a [u8]);
+
+impl<'a> Serialize for LeBytes<'a> {
+    fn serialize<S: Serializer>(&self, serializer: S) -> Result<S::Ok, S::Error> {
+        serializer.serialize_bytes(self.0)
+    }
+}
+
+/// Serialize the `write_le` output of a fixed-layout value, used by the derive macro
+#[doc(hidden)]
+pub fn serialize_le_bytes<S: Serializer>(bytes: &[u8], serializer: S) -> Result<S::Ok, S::Error> {
+    serializer.serialize_newtype_struct(NAME, &LeBytes(bytes))
+}
+
+/// Serialize a fixed-layout value as a whole, for use with `#[serde(with = "postcard::fixed")]`.
+pub fn serialize<S, T>(data: &T, serializer: S) -> Result<S::Ok, S::Error>
+where
+    S: Serializer,
+    T: FixedLayout,
+{
+    data.serialize_fixed(serializer)
+}
+
+/// Deserialize a fixed-layout value as a whole, for use with
+/// `#[serde(with = "postcard::fixed")]`.
+pub fn deserialize<'de, D, T>(deserializer: D) -> Result<T, D::Error>
+where
+    D: Deserializer<'de>,
+    T: FixedLayout,
+{
+    deserializer.deserialize_tuple_struct(NAME, T::SIZE, FixedVisitor(PhantomData))
+}
+
+struct FixedVisitor<T>(PhantomData<T>);
+
+impl<'de, T: FixedLayout> Visitor<'de> for FixedVisitor<T> {
+    type Value = T;
+
+    fn expecting(&self, formatter: &mut fmt::Formatter) -> fmt::Result {
+        write!(formatter, "{} bytes of a fixed-layout value", T::SIZE)
+    }
+
+    fn visit_bytes<E: de::Error>(self, v: &[u8]) -> Result<T, E> {
+        if v.len() != T::SIZE {
+            return Err(E::invalid_length(v.len(), &self));
+        }
+        T::read_le(v).ok_or_else(|| E::invalid_value(de::Unexpected::Bytes(v), &self))
+    }
+
+    // Self-describing formats may encode the byte string as a sequence of bytes
+    fn visit_seq<A: SeqAccess<'de>>(self, mut seq: A) -> Result<T, A::Error> {
+        with_buffer::<T, _>(|buf| {
+            for (i, out) in buf.iter_mut().enumerate() {
+                *out = seq
+                    .next_element()?
+                    .ok_or_else(|| de::Error::invalid_length(i, &self))?;
+            }
+            if seq.next_element::<de::IgnoredAny>()?.is_some() {
+                return Err(de::Error::invalid_length(T::SIZE + 1, &self));
+            }
+            self.visit_bytes(buf)
+        })
+    }
+}
+
+#[cfg(test)]
+mod test {
+    use super::*;
+    use crate::{from_bytes, to_slice};
+    use serde::{Deserialize, Serialize};
+
+    #[derive(Serialize, Deserialize, Debug, PartialEq)]
+    struct Msg {
+        #[serde(with = "crate::fixed")]
+        words: [u32; 3],
+        #[serde(with = "crate::fixed")]
+        flag: bool,
+        #[serde(with = "crate::fixed")]
+        temp: f64,
+    }
+
+    #[test]
+    fn matches_plain() {
+        let msg = Msg {
+            words: [1, 0x0102_0304, u32::MAX],
+            flag: true,
+            temp: -1.5,
+        };
+
+        let mut buf = [0u8; 32];
+        let mut plain = [0u8; 32];
+        let output = to_slice(&msg, &mut buf).unwrap();
+        assert_eq!(
+            output,
+            to_slice(&(msg.words, msg.flag, msg.temp), &mut plain).unwrap()
+        );
+        assert_eq!(output.len(), 21);
+
+        let out: Msg = from_bytes(output).unwrap();
+        assert_eq!(out, msg);
+
+        assert_eq!(
+            from_bytes::<Msg>(&output[..20]),
+            Err(crate::Error::DeserializeUnexpectedEnd)
+        );
+        output[12] = 2;
+        assert!(from_bytes::<Msg>(output).is_err());
+
+        // Too small to serialize into
+        assert_eq!(
+            to_slice(&msg, &mut buf[..20]),
+            Err(crate::Error::SerializeBufferFull)
+        );
+    }
+
+    #[test]
+    fn read_write() {
+        let mut buf = [0u8; 8];
+        <[i16; 4]>::write_le(&[-1, 2, -3, 4], &mut buf);
+        assert_eq!(buf, [0xFF, 0xFF, 0x02, 0x00, 0xFD, 0xFF, 0x04, 0x00]);
+        assert_eq!(<[i16; 4]>::read_le(&buf), Some([-1, 2, -3, 4]));
+        assert_eq!(<[bool; 2]>::read_le(&[1, 2]), None);
+    }
+}
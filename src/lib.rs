@@ -140,6 +140,11 @@
 //! assert_eq!(res, &[0x03, 0x04, 0x01, 0x03, 0x20, 0x30, 0x00]);
 //! ```
 //!
+//! ## Minimum Supported Rust Version
+//!
+//! The `parallel` module, enabled by the `use-std` feature, uses `std::thread::scope` and
+//! requires Rust 1.63 or newer.
+//!
 //! ## License
 //!
 //! Licensed under either of
@@ -159,18 +164,51 @@
 #![cfg_attr(not(any(test, feature = "use-std")), no_std)]
 #![warn(missing_docs)]
 
+pub mod accumulator;
+pub mod arena;
+pub mod bulk;
+pub mod crc;
 mod de;
 mod error;
+pub mod fixed;
+pub mod max_size;
+mod scan;
 mod ser;
 mod varint;
 
+#[cfg(feature = "use-std")]
+pub mod parallel;
+
+pub use arena::DeserializeIn;
 pub use de::deserializer::Deserializer;
-pub use de::{from_bytes, from_bytes_cobs, take_from_bytes, take_from_bytes_cobs};
+pub use de::iter::{FromBytesCobsIter, FromBytesIter};
+pub use de::{
+    from_bytes, from_bytes_cobs, from_bytes_cobs_in_place, from_bytes_crc, from_bytes_in,
+    from_bytes_in_place, from_bytes_trusted, iter_from_bytes, iter_from_bytes_cobs,
+    take_from_bytes, take_from_bytes_cobs, take_from_bytes_length_prefixed, validate,
+};
 pub use error::{Error, Result};
+pub use fixed::FixedLayout;
+pub use max_size::MaxSize;
 pub use ser::{
-    flavors, serialize_with_flavor, serializer::Serializer, to_slice, to_slice_cobs,
+    flavors, serialize_with_flavor, serialized_size, serializer::Serializer, to_slice,
+    to_slice_cobs, to_slice_crc,
 };
 
+#[cfg(feature = "derive")]
+pub use postcard_derive::{DeserializeIn, FixedLayout, MaxSize};
+
+// Used by the derive macros, not public API
+#[doc(hidden)]
+pub mod __private {
+    pub use crate::arena::next_field;
+    pub use crate::fixed::sealed::Sealed as FixedLayoutSealed;
+    pub use core::fmt::{Formatter, Result as FmtResult};
+    pub use core::marker::PhantomData;
+    pub use serde::de::{Deserializer, SeqAccess, Visitor};
+    pub use serde::ser::Serializer;
+}
+
 #[cfg(feature = "heapless")]
 pub use ser::{to_vec, to_vec_cobs};
 
@@ -179,3 +217,6 @@ pub use ser::{to_stdvec, to_stdvec_cobs};
 
 #[cfg(feature = "alloc")]
 pub use ser::{to_allocvec, to_allocvec_cobs};
+
+#[cfg(any(feature = "alloc", feature = "use-std"))]
+pub use ser::{to_extend, to_extend_cobs};
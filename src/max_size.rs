@@ -0,0 +1,147 @@
+//! # Maximum Serialized Size
+//!
+//! The [`MaxSize`] trait gives the largest number of bytes that any value of a type can
+//! serialize to. As the size is an associated constant, it can be used to size buffers
+//! at compile time, or to statically check that a message fits into a fixed-size buffer.
+//!
+//! `MaxSize` is implemented for primitives, arrays, tuples, `Option`, `Result` and (with the
+//! `heapless` feature) `heapless::Vec` and `heapless::String`. It can be derived for structs
+//! and enums with the `derive` feature. Types without an upper bound on their size, such as
+//! `&[u8]`, `&str` or `alloc::vec::Vec`, do not implement `MaxSize`.
+//!
+//! ## Example
+//!
+//! ```rust
+//! # #[cfg(all(feature = "heapless", feature = "derive"))] {
+//! use postcard::{to_vec, MaxSize};
+//! use serde::Serialize;
+//!
+//! #[derive(Serialize, MaxSize)]
+//! struct Reading {
+//!     channel: u8,
+//!     value: Option<f32>,
+//! }
+//!
+//! // Statically check that a reading always fits a 16 byte DMA buffer
+//! const _: () = assert!(Reading::POSTCARD_MAX_SIZE <= 16);
+//!
+//! let reading = Reading { channel: 3, value: Some(1.5) };
+//! let output = to_vec::<_, { Reading::POSTCARD_MAX_SIZE }>(&reading).unwrap();
+//! assert_eq!(output.len(), 6);
+//! # }
+//! ```
+
+use crate::varint::VarintUsize;
+use core::marker::PhantomData;
+
+/// The largest possible serialized size of a type, in bytes.
+///
+/// See the [module level documentation](./max_size/index.html) for more information.
+pub trait MaxSize {
+    /// The maximum number of bytes any value of this type serializes to
+    const POSTCARD_MAX_SIZE: usize;
+}
+
+/// The number of bytes needed to encode `value` as a varint, such as the length prefix
+/// of a sequence with at most `value` elements, or the discriminant of an enum whose
+/// last variant has index `value`.
+pub const fn varint_max_size(value: usize) -> usize {
+    VarintUsize(value).varint_len()
+}
+
+/// The largest possible size of `raw_size` bytes after COBS encoding, as produced by
+/// `to_slice_cobs` and friends, including the terminating sentinel `0x00` byte.
+///
+/// COBS adds one leading code byte, one additional code byte for every run of 254
+/// non-zero bytes, and the sentinel.
+pub const fn cobs_max_size(raw_size: usize) -> usize {
+    raw_size + (raw_size / 254) + 2
+}
+
+macro_rules! impl_fixed {
+    ($($ty:ty => $size:expr),* $(,)?) => {
+        $(
+            impl MaxSize for $ty {
+                const POSTCARD_MAX_SIZE: usize = $size;
+            }
+        )*
+    };
+}
+
+// `usize` and `isize` are serialized by serde as `u64` and `i64`
+impl_fixed! {
+    () => 0,
+    bool => 1,
+    u8 => 1,
+    i8 => 1,
+    u16 => 2,
+    i16 => 2,
+    u32 => 4,
+    i32 => 4,
+    f32 => 4,
+    u64 => 8,
+    i64 => 8,
+    f64 => 8,
+    usize => 8,
+    isize => 8,
+    u128 => 16,
+    i128 => 16,
+    char => 5,
+    core::num::NonZeroU8 => 1,
+    core::num::NonZeroU16 => 2,
+    core::num::NonZeroU32 => 4,
+    core::num::NonZeroU64 => 8,
+    core::num::NonZeroU128 => 16,
+}
+
+impl<T: ?Sized> MaxSize for PhantomData<T> {
+    const POSTCARD_MAX_SIZE: usize = 0;
+}
+
+impl<T: MaxSize + ?Sized> MaxSize for &T {
+    const POSTCARD_MAX_SIZE: usize = T::POSTCARD_MAX_SIZE;
+}
+
+impl<T: MaxSize> MaxSize for Option<T> {
+    const POSTCARD_MAX_SIZE: usize = 1 + T::POSTCARD_MAX_SIZE;
+}
+
+impl<T: MaxSize, E: MaxSize> MaxSize for Result<T, E> {
+    const POSTCARD_MAX_SIZE: usize = 1 + if T::POSTCARD_MAX_SIZE > E::POSTCARD_MAX_SIZE {
+        T::POSTCARD_MAX_SIZE
+    } else {
+        E::POSTCARD_MAX_SIZE
+    };
+}
+
+// Arrays are serialized as tuples, without a length prefix
+impl<T: MaxSize, const N: usize> MaxSize for [T; N] {
+    const POSTCARD_MAX_SIZE: usize = T::POSTCARD_MAX_SIZE * N;
+}
+
+macro_rules! impl_tuple {
+    ($($name:ident),+) => {
+        impl<$($name: MaxSize),+> MaxSize for ($($name,)+) {
+            const POSTCARD_MAX_SIZE: usize = 0 $(+ $name::POSTCARD_MAX_SIZE)+;
+        }
+    };
+}
+
+impl_tuple!(A);
+impl_tuple!(A, B);
+impl_tuple!(A, B, C);
+impl_tuple!(A, B, C, D);
+impl_tuple!(A, B, C, D, E);
+impl_tuple!(A, B, C, D, E, F);
+impl_tuple!(A, B, C, D, E, F, G);
+impl_tuple!(A, B, C, D, E, F, G, H);
+
+#[cfg(feature = "heapless")]
+impl<T: MaxSize, const N: usize> MaxSize for heapless::Vec<T, N> {
+    const POSTCARD_MAX_SIZE: usize = varint_max_size(N) + (T::POSTCARD_MAX_SIZE * N);
+}
+
+#[cfg(feature = "heapless")]
+impl<const N: usize> MaxSize for heapless::String<N> {
+    const POSTCARD_MAX_SIZE: usize = varint_max_size(N) + N;
+}
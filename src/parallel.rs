@@ -0,0 +1,275 @@
+//! # Parallel COBS Decoding
+//!
+//! Large captures of back-to-back COBS frames, as produced by `to_slice_cobs` and friends,
+//! can be decoded on all available cores with [`ParallelCobs`].
+//!
+//! The buffer is first split into chunks of roughly `chunk_size` bytes, each ending on a
+//! frame terminator. Idle worker threads then repeatedly take the next undecoded chunk,
+//! and decode its frames in place, as with
+//! [`iter_from_bytes_cobs`](crate::iter_from_bytes_cobs). Results are returned in the
+//! order of the frames in the buffer.
+//!
+//! An unterminated frame at the end of the buffer is not decoded, but returned along with
+//! the results, so that it can be completed by the next capture when streaming.
+//!
+//! This module is only available with the `use-std` feature, and requires Rust 1.63 or
+//! newer for `std::thread::scope`.
+//!
+//! ## Example
+//!
+//! ```rust
+//! use postcard::{parallel::ParallelCobs, to_stdvec_cobs};
+//!
+//! let mut capture = Vec::new();
+//! for i in 0..1000u32 {
+//!     capture.extend_from_slice(&to_stdvec_cobs(&(i, i * 3)).unwrap());
+//! }
+//!
+//! // The start of a frame that has not been fully received yet
+//! capture.extend_from_slice(&[0x03, 0x01]);
+//!
+//! let (messages, remainder) = ParallelCobs::new()
+//!     .chunk_size(512)
+//!     .decode::<(u32, u32)>(&mut capture);
+//!
+//! assert_eq!(remainder, &[0x03, 0x01]);
+//! assert_eq!(messages.len(), 1000);
+//! for (i, msg) in messages.into_iter().enumerate() {
+//!     let (_offset, (a, b)) = msg.unwrap();
+//!     assert_eq!((a, b), (i as u32, i as u32 * 3));
+//! }
+//! ```
+
+use std::sync::Mutex;
+use std::thread;
+use std::vec::Vec;
+
+use serde::Deserialize;
+
+use crate::de::iter_from_bytes_cobs;
+use crate::error::Result;
+use crate::scan::find_zero;
+
+/// The default number of bytes decoded by a worker thread at a time
+pub const DEFAULT_CHUNK_SIZE: usize = 1024 * 1024;
+
+/// A parallel decoder for buffers of back-to-back COBS frames.
+///
+/// See the [module level documentation](./index.html) for more information.
+#[derive(Debug, Clone)]
+pub struct ParallelCobs {
+    chunk_size: usize,
+    threads: usize,
+}
+
+impl ParallelCobs {
+    /// Create a decoder with the default chunk size, using all available cores
+    pub fn new() -> Self {
+        ParallelCobs {
+            chunk_size: DEFAULT_CHUNK_SIZE,
+            threads: 0,
+        }
+    }
+
+    /// Set the minimum number of bytes handed to a worker thread at a time. Chunks are
+    /// extended to the end of the frame they would otherwise split.
+    ///
+    /// Smaller chunks balance the load better, larger chunks have less overhead.
+    pub fn chunk_size(mut self, bytes: usize) -> Self {
+        self.chunk_size = bytes.max(1);
+        self
+    }
+
+    /// Set the number of worker threads. `0`, the default, uses the available
+    /// parallelism of the machine.
+    pub fn threads(mut self, threads: usize) -> Self {
+        self.threads = threads;
+        self
+    }
+
+    /// Decode all frames in `buf` in place.
+    ///
+    /// Returns one item per frame, in order, with the same contents as the items of
+    /// [`iter_from_bytes_cobs`](crate::iter_from_bytes_cobs): the byte offset of the
+    /// frame within `buf` and the message, or the error for a frame that failed to
+    /// decode.
+    ///
+    /// Also returns the bytes after the last frame terminator, such as an unterminated
+    /// frame at the end of `buf`. These are not decoded or modified.
+    pub fn decode<'a, T>(&self, buf: &'a mut [u8]) -> (Vec<Result<(usize, T)>>, &'a [u8])
+    where
+        T: Deserialize<'a> + Send,
+    {
+        let end = buf.iter().rposition(|b| *b == 0).map_or(0, |pos| pos + 1);
+        let (buf, remainder) = buf.split_at_mut(end);
+        (self.decode_frames(buf), remainder)
+    }
+
+    /// Decode `buf`, which ends on a frame terminator
+    fn decode_frames<'a, T>(&self, buf: &'a mut [u8]) -> Vec<Result<(usize, T)>>
+    where
+        T: Deserialize<'a> + Send,
+    {
+        let chunks = split_chunks(buf, self.chunk_size);
+        let threads = match self.threads {
+            0 => thread::available_parallelism().map_or(1, |n| n.get()),
+            n => n,
+        }
+        .min(chunks.len());
+
+        if threads <= 1 {
+            return chunks.into_iter().flat_map(decode_chunk).collect();
+        }
+
+        let mut ordered: Vec<Vec<Result<(usize, T)>>> = Vec::new();
+        ordered.resize_with(chunks.len(), Vec::new);
+        let jobs = Mutex::new(chunks.into_iter().enumerate());
+
+        thread::scope(|s| {
+            let workers: Vec<_> = (0..threads)
+                .map(|_| {
+                    s.spawn(|| {
+                        let mut done = Vec::new();
+                        loop {
+                            let job = jobs.lock().unwrap().next();
+                            match job {
+                                Some((idx, chunk)) => done.push((idx, decode_chunk(chunk))),
+                                None => return done,
+                            }
+                        }
+                    })
+                })
+                .collect();
+
+            for worker in workers {
+                let done = worker
+                    .join()
+                    .unwrap_or_else(|e| std::panic::resume_unwind(e));
+                for (idx, frames) in done {
+                    ordered[idx] = frames;
+                }
+            }
+        });
+
+        ordered.into_iter().flatten().collect()
+    }
+}
+
+impl Default for ParallelCobs {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+/// Split `buf` into chunks of at least `chunk_size` bytes that end on a frame terminator,
+/// along with their offset within `buf`. The last chunk holds whatever remains.
+fn split_chunks(buf: &mut [u8], chunk_size: usize) -> Vec<(usize, &mut [u8])> {
+    let mut chunks = Vec::with_capacity(buf.len() / chunk_size + 1);
+    let mut offset = 0;
+    let mut rest = buf;
+
+    while !rest.is_empty() {
+        let search_from = chunk_size.min(rest.len()) - 1;
+        let end = match find_zero(&rest[search_from..]) {
+            Some(n) => search_from + n + 1,
+            None => rest.len(),
+        };
+        let (chunk, tail) = core::mem::take(&mut rest).split_at_mut(end);
+        chunks.push((offset, chunk));
+        offset += end;
+        rest = tail;
+    }
+
+    chunks
+}
+
+fn decode_chunk<'a, T>((offset, chunk): (usize, &'a mut [u8])) -> Vec<Result<(usize, T)>>
+where
+    T: Deserialize<'a>,
+{
+    iter_from_bytes_cobs::<T>(chunk)
+        .map(|frame| frame.map(|(pos, t)| (offset + pos, t)))
+        .collect()
+}
+
+#[cfg(test)]
+mod test {
+    use super::*;
+    use crate::error::Error;
+    use crate::to_stdvec_cobs;
+
+    fn capture() -> Vec<u8> {
+        let mut capture = Vec::new();
+        for i in 0..500u32 {
+            let name = "x".repeat((i % 300) as usize);
+            capture.extend_from_slice(&to_stdvec_cobs(&(i << 8, name.as_str())).unwrap());
+            if i % 97 == 0 {
+                // A frame that fails to decode
+                capture.extend_from_slice(&[0x09, 0x00]);
+            }
+        }
+        // An unterminated tail
+        capture.extend_from_slice(TAIL);
+        capture
+    }
+
+    const TAIL: &[u8] = &[0x03, 0x01];
+
+    #[test]
+    fn matches_sequential() {
+        let mut expected_buf = capture();
+        let expected: Vec<_> = iter_from_bytes_cobs::<(u32, &str)>(&mut expected_buf).collect();
+        assert_eq!(expected.len(), 506);
+        assert_eq!(expected[1], Err(Error::DeserializeBadEncoding));
+
+        for &chunk_size in &[1, 7, 300, 4096, 1 << 20] {
+            for &threads in &[0, 1, 3, 8] {
+                let mut buf = capture();
+                let (decoded, remainder) = ParallelCobs::new()
+                    .chunk_size(chunk_size)
+                    .threads(threads)
+                    .decode::<(u32, &str)>(&mut buf);
+                assert_eq!(decoded, expected);
+                assert_eq!(remainder, TAIL);
+            }
+        }
+    }
+
+    #[test]
+    fn carries_remainder() {
+        let mut stream = to_stdvec_cobs(&(1u32, "one")).unwrap();
+        stream.extend_from_slice(&to_stdvec_cobs(&(2u32, "two")).unwrap());
+        let (first, second) = stream.split_at(stream.len() - 3);
+
+        let mut buf = first.to_vec();
+        let (decoded, remainder) = ParallelCobs::new().decode::<(u32, &str)>(&mut buf);
+        assert_eq!(decoded, vec![Ok((0, (1, "one")))]);
+        let mut buf = [remainder, second].concat();
+
+        let (decoded, remainder) = ParallelCobs::new().decode::<(u32, &str)>(&mut buf);
+        assert_eq!(decoded, vec![Ok((0, (2, "two")))]);
+        assert!(remainder.is_empty());
+
+        let mut buf = [0x03, 0x01, 0x02];
+        let (decoded, remainder) = ParallelCobs::new().decode::<(u32, &str)>(&mut buf);
+        assert!(decoded.is_empty());
+        assert_eq!(remainder, &[0x03, 0x01, 0x02]);
+    }
+
+    #[test]
+    fn chunks_end_on_frames() {
+        let mut buf = capture();
+        let len = buf.len();
+        let chunks = split_chunks(&mut buf, 1000);
+        let mut expected_offset = 0;
+        for (offset, chunk) in chunks.iter() {
+            assert_eq!(*offset, expected_offset);
+            expected_offset += chunk.len();
+            if expected_offset != len {
+                assert!(chunk.len() >= 1000);
+                assert_eq!(chunk.last(), Some(&0));
+            }
+        }
+        assert_eq!(expected_offset, len);
+    }
+}
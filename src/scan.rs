@@ -0,0 +1,52 @@
+//! Byte scanning helpers shared by the COBS encoder and decoder.
+
+const WORD: usize = core::mem::size_of::<usize>();
+const LO: usize = usize::max_value() / 0xFF;
+const HI: usize = LO << 7;
+
+/// Whether any byte of `word` is zero
+#[inline(always)]
+fn has_zero(word: usize) -> bool {
+    (word.wrapping_sub(LO) & !word & HI) != 0
+}
+
+/// Find the index of the first `0x00` byte in `data`.
+///
+/// The bulk of the data is checked a machine word at a time, which is portable,
+/// needs no target features, and is typically auto-vectorized.
+#[inline]
+pub(crate) fn find_zero(data: &[u8]) -> Option<usize> {
+    let mut chunks = data.chunks_exact(WORD);
+    let mut offset = 0;
+    for chunk in &mut chunks {
+        let mut buf = [0u8; WORD];
+        buf.copy_from_slice(chunk);
+        if has_zero(usize::from_ne_bytes(buf)) {
+            break;
+        }
+        offset += WORD;
+    }
+    data[offset..].iter().position(|b| *b == 0).map(|pos| offset + pos)
+}
+
+#[cfg(test)]
+mod test {
+    use super::find_zero;
+
+    #[test]
+    fn finds_first_zero() {
+        let mut data = [0xFFu8; 67];
+        assert_eq!(find_zero(&data), None);
+        assert_eq!(find_zero(&[]), None);
+
+        for i in (0..data.len()).rev() {
+            data[i] = 0;
+            assert_eq!(find_zero(&data), Some(i));
+            assert_eq!(find_zero(&data[..i]), None);
+        }
+
+        // 0x80 and 0x01 bytes next to each other must not look like a zero
+        let tricky = [0x80u8, 0x01, 0x80, 0x01, 0x01, 0x80, 0x01, 0x80, 0x00];
+        assert_eq!(find_zero(&tricky), Some(8));
+    }
+}
@@ -71,9 +71,10 @@
 //! assert_eq!(res, &[0x03, 0x04, 0x01, 0x03, 0x20, 0x30, 0x00]);
 //! ```
 
+use crate::crc::{Crc32, CrcAlgorithm};
 use crate::error::{Error, Result};
+use crate::scan::find_zero;
 use crate::varint::VarintUsize;
-use cobs::{EncoderState, PushResult};
 use core::ops::Index;
 use core::ops::IndexMut;
 
@@ -86,6 +87,9 @@ pub use std_vec::*;
 #[cfg(feature = "alloc")]
 pub use alloc_vec::*;
 
+#[cfg(any(feature = "alloc", feature = "use-std"))]
+pub use extend_vec::*;
+
 /// The SerFlavor trait acts as a combinator/middleware interface that can be used to pass bytes
 /// through storage or modification flavors. See the module level documentation for more information
 /// and examples.
@@ -116,11 +120,106 @@ pub trait SerFlavor {
         self.try_extend(used_buf)
     }
 
+    /// The written() trait method returns the number of bytes stored so far, for flavors that
+    /// support revisiting them with `try_splice()`. Serializing sequences and maps of unknown
+    /// length requires this. The default implementation returns `None`.
+    fn written(&self) -> Option<usize> {
+        None
+    }
+
+    /// The try_splice() trait method replaces the `len` bytes stored at offset `at`, as counted by
+    /// `written()`, with `data`, which may be shorter or longer than `len`. Any bytes stored after
+    /// them are moved once. The default implementation returns an error.
+    fn try_splice(
+        &mut self,
+        _at: usize,
+        _len: usize,
+        _data: &[u8],
+    ) -> core::result::Result<(), ()> {
+        Err(())
+    }
+
     /// The release() trait method finalizes the modification or storage operation, and resolved into
     /// the type defined by `SerFlavor::Output` associated type.
     fn release(self) -> core::result::Result<Self::Output, ()>;
 }
 
+/// Check a `try_splice()` of `len` bytes at offset `at` against the `used` bytes of a
+/// buffer, and return the number of bytes used after replacing them with `data`.
+fn spliced_len(
+    used: usize,
+    at: usize,
+    len: usize,
+    data: &[u8],
+) -> core::result::Result<usize, ()> {
+    match at.checked_add(len) {
+        Some(end) if end <= used => Ok(used - len + data.len()),
+        _ => Err(()),
+    }
+}
+
+/// Replace `buf[at..at + len]` with `data`, moving the bytes after them, up to `used`, in
+/// one go. `buf` must be long enough for the result, as checked by `spliced_len()`.
+fn splice_at(buf: &mut [u8], used: usize, at: usize, len: usize, data: &[u8]) {
+    buf.copy_within(at + len..used, at + data.len());
+    buf[at..at + data.len()].copy_from_slice(data);
+}
+
+/// The ResettableFlavor trait is implemented by flavors that can serialize any number of
+/// messages one after another, keeping any state they hold, instead of being released after
+/// a single message.
+///
+/// Each message is serialized into the flavor as usual, then `finish()` finalizes it like
+/// `release()` would, and returns the serialized bytes. `reset()` then discards those bytes
+/// and prepares the flavor for the next message. See
+/// [`Serializer::finish()`](../struct.Serializer.html#method.finish) for an example.
+///
+/// A `&mut F` is also a flavor whenever `F` is a `ResettableFlavor`. It resolves into the
+/// output of `finish()`, which allows passing a long-lived flavor to
+/// [`serialize_with_flavor()`](../fn.serialize_with_flavor.html) by reference.
+pub trait ResettableFlavor: SerFlavor {
+    /// Finalize the current message, and return the serialized bytes. This must be followed by
+    /// a call to `reset()` before the flavor is used again.
+    fn finish(&mut self) -> core::result::Result<&[u8], ()>;
+
+    /// Discard the output of the previous message, and prepare for the next one
+    fn reset(&mut self) -> core::result::Result<(), ()>;
+}
+
+impl<'a, F> SerFlavor for &'a mut F
+where
+    F: ResettableFlavor,
+{
+    type Output = &'a [u8];
+
+    #[inline(always)]
+    fn try_extend(&mut self, data: &[u8]) -> core::result::Result<(), ()> {
+        (**self).try_extend(data)
+    }
+
+    #[inline(always)]
+    fn try_push(&mut self, data: u8) -> core::result::Result<(), ()> {
+        (**self).try_push(data)
+    }
+
+    #[inline(always)]
+    fn try_push_varint_usize(&mut self, data: &VarintUsize) -> core::result::Result<(), ()> {
+        (**self).try_push_varint_usize(data)
+    }
+
+    fn written(&self) -> Option<usize> {
+        (**self).written()
+    }
+
+    fn try_splice(&mut self, at: usize, len: usize, data: &[u8]) -> core::result::Result<(), ()> {
+        (**self).try_splice(at, len, data)
+    }
+
+    fn release(self) -> core::result::Result<Self::Output, ()> {
+        self.finish()
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Storage Flavors
 ////////////////////////////////////////////////////////////////////////////////
@@ -171,12 +270,37 @@ impl<'a> SerFlavor for Slice<'a> {
         Ok(())
     }
 
+    fn written(&self) -> Option<usize> {
+        Some(self.idx)
+    }
+
+    fn try_splice(&mut self, at: usize, len: usize, data: &[u8]) -> core::result::Result<(), ()> {
+        let idx = spliced_len(self.idx, at, len, data)?;
+        if idx > self.buf.len() {
+            return Err(());
+        }
+        splice_at(self.buf, self.idx, at, len, data);
+        self.idx = idx;
+        Ok(())
+    }
+
     fn release(self) -> core::result::Result<Self::Output, ()> {
         let (used, _unused) = self.buf.split_at_mut(self.idx);
         Ok(used)
     }
 }
 
+impl<'a> ResettableFlavor for Slice<'a> {
+    fn finish(&mut self) -> core::result::Result<&[u8], ()> {
+        Ok(&self.buf[..self.idx])
+    }
+
+    fn reset(&mut self) -> core::result::Result<(), ()> {
+        self.idx = 0;
+        Ok(())
+    }
+}
+
 impl<'a> Index<usize> for Slice<'a> {
     type Output = u8;
 
@@ -191,10 +315,60 @@ impl<'a> IndexMut<usize> for Slice<'a> {
     }
 }
 
+////////////////////////////////////////
+// Size
+////////////////////////////////////////
+
+/// The `Size` flavor is a storage flavor that stores nothing. It only counts the number of
+/// bytes that would have been written, and resolves into that count. This is useful to
+/// learn the exact serialized size of a message before allocating a buffer for it.
+///
+/// As no bytes are retained, `Size` cannot be used as the storage flavor for modification
+/// flavors such as `Cobs`, which need to revisit previously written bytes.
+#[derive(Default)]
+pub struct Size {
+    size: usize,
+}
+
+impl SerFlavor for Size {
+    type Output = usize;
+
+    #[inline(always)]
+    fn try_extend(&mut self, data: &[u8]) -> core::result::Result<(), ()> {
+        self.size += data.len();
+        Ok(())
+    }
+
+    #[inline(always)]
+    fn try_push(&mut self, _data: u8) -> core::result::Result<(), ()> {
+        self.size += 1;
+        Ok(())
+    }
+
+    #[inline(always)]
+    fn try_push_varint_usize(&mut self, data: &VarintUsize) -> core::result::Result<(), ()> {
+        self.size += data.varint_len();
+        Ok(())
+    }
+
+    fn written(&self) -> Option<usize> {
+        Some(self.size)
+    }
+
+    fn try_splice(&mut self, at: usize, len: usize, data: &[u8]) -> core::result::Result<(), ()> {
+        self.size = spliced_len(self.size, at, len, data)?;
+        Ok(())
+    }
+
+    fn release(self) -> core::result::Result<Self::Output, ()> {
+        Ok(self.size)
+    }
+}
+
 #[cfg(feature = "heapless")]
 mod heapless_vec {
     use heapless::Vec;
-    use super::SerFlavor;
+    use super::{splice_at, spliced_len, ResettableFlavor, SerFlavor};
     use super::Index;
     use super::IndexMut;
 
@@ -219,11 +393,40 @@ mod heapless_vec {
             self.0.push(data).map_err(|_| ())
         }
 
+        fn written(&self) -> Option<usize> {
+            Some(self.0.len())
+        }
+
+        fn try_splice(
+            &mut self,
+            at: usize,
+            len: usize,
+            data: &[u8],
+        ) -> core::result::Result<(), ()> {
+            let used = self.0.len();
+            let new_len = spliced_len(used, at, len, data)?;
+            self.0.resize(used.max(new_len), 0)?;
+            splice_at(&mut self.0[..], used, at, len, data);
+            self.0.truncate(new_len);
+            Ok(())
+        }
+
         fn release(self) -> core::result::Result<Vec<u8, B>, ()> {
             Ok(self.0)
         }
     }
 
+    impl<const B: usize> ResettableFlavor for HVec<B> {
+        fn finish(&mut self) -> core::result::Result<&[u8], ()> {
+            Ok(&self.0)
+        }
+
+        fn reset(&mut self) -> core::result::Result<(), ()> {
+            self.0.clear();
+            Ok(())
+        }
+    }
+
     impl<const B: usize> Index<usize> for HVec<B> {
         type Output = u8;
 
@@ -243,13 +446,97 @@ mod heapless_vec {
             Self(Vec::new())
         }
     }
+
+    ////////////////////////////////////////
+    // ExtendHVec
+    ////////////////////////////////////////
+
+    /// The `ExtendHVec` flavor appends to a borrowed `heapless::Vec`, keeping its existing
+    /// contents. It resolves into the appended portion of the `Vec`.
+    ///
+    /// Indexing is relative to the first appended byte, so modification flavors such as
+    /// `Cobs` only see the bytes of the current message.
+    pub struct ExtendHVec<'a, const B: usize> {
+        vec: &'a mut Vec<u8, B>,
+        start: usize,
+    }
+
+    impl<'a, const B: usize> ExtendHVec<'a, B> {
+        /// Create a new `ExtendHVec` flavor, appending to the given `Vec`
+        pub fn new(vec: &'a mut Vec<u8, B>) -> Self {
+            let start = vec.len();
+            ExtendHVec { vec, start }
+        }
+    }
+
+    impl<'a, const B: usize> SerFlavor for ExtendHVec<'a, B> {
+        type Output = &'a mut [u8];
+
+        #[inline(always)]
+        fn try_extend(&mut self, data: &[u8]) -> core::result::Result<(), ()> {
+            self.vec.extend_from_slice(data)
+        }
+
+        #[inline(always)]
+        fn try_push(&mut self, data: u8) -> core::result::Result<(), ()> {
+            self.vec.push(data).map_err(|_| ())
+        }
+
+        fn written(&self) -> Option<usize> {
+            Some(self.vec.len() - self.start)
+        }
+
+        fn try_splice(
+            &mut self,
+            at: usize,
+            len: usize,
+            data: &[u8],
+        ) -> core::result::Result<(), ()> {
+            let used = self.vec.len() - self.start;
+            let new_len = spliced_len(used, at, len, data)?;
+            self.vec.resize(self.start + used.max(new_len), 0)?;
+            splice_at(&mut self.vec[self.start..], used, at, len, data);
+            self.vec.truncate(self.start + new_len);
+            Ok(())
+        }
+
+        fn release(self) -> core::result::Result<Self::Output, ()> {
+            let ExtendHVec { vec, start } = self;
+            Ok(&mut vec[start..])
+        }
+    }
+
+    impl<'a, const B: usize> ResettableFlavor for ExtendHVec<'a, B> {
+        fn finish(&mut self) -> core::result::Result<&[u8], ()> {
+            Ok(&self.vec[self.start..])
+        }
+
+        fn reset(&mut self) -> core::result::Result<(), ()> {
+            self.vec.truncate(self.start);
+            Ok(())
+        }
+    }
+
+    impl<'a, const B: usize> Index<usize> for ExtendHVec<'a, B> {
+        type Output = u8;
+
+        fn index(&self, idx: usize) -> &u8 {
+            &self.vec[self.start + idx]
+        }
+    }
+
+    impl<'a, const B: usize> IndexMut<usize> for ExtendHVec<'a, B> {
+        fn index_mut(&mut self, idx: usize) -> &mut u8 {
+            &mut self.vec[self.start + idx]
+        }
+    }
 }
 
 #[cfg(feature = "use-std")]
 mod std_vec {
     extern crate std;
     use std::vec::Vec;
-    use super::SerFlavor;
+    use super::{splice_at, spliced_len, ResettableFlavor, SerFlavor};
     use super::Index;
     use super::IndexMut;
 
@@ -273,11 +560,40 @@ mod std_vec {
             Ok(())
         }
 
+        fn written(&self) -> Option<usize> {
+            Some(self.0.len())
+        }
+
+        fn try_splice(
+            &mut self,
+            at: usize,
+            len: usize,
+            data: &[u8],
+        ) -> core::result::Result<(), ()> {
+            let used = self.0.len();
+            let new_len = spliced_len(used, at, len, data)?;
+            self.0.resize(used.max(new_len), 0);
+            splice_at(&mut self.0[..], used, at, len, data);
+            self.0.truncate(new_len);
+            Ok(())
+        }
+
         fn release(self) -> core::result::Result<Self::Output, ()> {
             Ok(self.0)
         }
     }
 
+    impl ResettableFlavor for StdVec {
+        fn finish(&mut self) -> core::result::Result<&[u8], ()> {
+            Ok(&self.0)
+        }
+
+        fn reset(&mut self) -> core::result::Result<(), ()> {
+            self.0.clear();
+            Ok(())
+        }
+    }
+
     impl Index<usize> for StdVec {
         type Output = u8;
 
@@ -297,7 +613,7 @@ mod std_vec {
 mod alloc_vec {
     extern crate alloc;
     use alloc::vec::Vec;
-    use super::SerFlavor;
+    use super::{splice_at, spliced_len, ResettableFlavor, SerFlavor};
     use super::Index;
     use super::IndexMut;
 
@@ -321,11 +637,40 @@ mod alloc_vec {
             Ok(())
         }
 
+        fn written(&self) -> Option<usize> {
+            Some(self.0.len())
+        }
+
+        fn try_splice(
+            &mut self,
+            at: usize,
+            len: usize,
+            data: &[u8],
+        ) -> core::result::Result<(), ()> {
+            let used = self.0.len();
+            let new_len = spliced_len(used, at, len, data)?;
+            self.0.resize(used.max(new_len), 0);
+            splice_at(&mut self.0[..], used, at, len, data);
+            self.0.truncate(new_len);
+            Ok(())
+        }
+
         fn release(self) -> core::result::Result<Self::Output, ()> {
             Ok(self.0)
         }
     }
 
+    impl ResettableFlavor for AllocVec {
+        fn finish(&mut self) -> core::result::Result<&[u8], ()> {
+            Ok(&self.0)
+        }
+
+        fn reset(&mut self) -> core::result::Result<(), ()> {
+            self.0.clear();
+            Ok(())
+        }
+    }
+
     impl Index<usize> for AllocVec {
         type Output = u8;
 
@@ -341,6 +686,102 @@ mod alloc_vec {
     }
 }
 
+#[cfg(any(feature = "alloc", feature = "use-std"))]
+mod extend_vec {
+    extern crate alloc;
+    use alloc::vec::Vec;
+    use super::{splice_at, spliced_len, ResettableFlavor, SerFlavor};
+    use super::Index;
+    use super::IndexMut;
+
+    /// The `ExtendVec` flavor appends to a borrowed `Vec<u8>`, keeping its existing
+    /// contents and capacity. It resolves into the appended portion of the `Vec`.
+    ///
+    /// Clearing and reusing one `Vec` for many messages avoids allocating a new buffer,
+    /// and growing it, for every message. Indexing is relative to the first appended
+    /// byte, so modification flavors such as `Cobs` only see the bytes of the current
+    /// message.
+    ///
+    /// This type is only available when the (non-default) `alloc` or `use-std` feature
+    /// is active
+    pub struct ExtendVec<'a> {
+        vec: &'a mut Vec<u8>,
+        start: usize,
+    }
+
+    impl<'a> ExtendVec<'a> {
+        /// Create a new `ExtendVec` flavor, appending to the given `Vec`
+        pub fn new(vec: &'a mut Vec<u8>) -> Self {
+            let start = vec.len();
+            ExtendVec { vec, start }
+        }
+    }
+
+    impl<'a> SerFlavor for ExtendVec<'a> {
+        type Output = &'a mut [u8];
+
+        #[inline(always)]
+        fn try_extend(&mut self, data: &[u8]) -> core::result::Result<(), ()> {
+            self.vec.extend_from_slice(data);
+            Ok(())
+        }
+
+        #[inline(always)]
+        fn try_push(&mut self, data: u8) -> core::result::Result<(), ()> {
+            self.vec.push(data);
+            Ok(())
+        }
+
+        fn written(&self) -> Option<usize> {
+            Some(self.vec.len() - self.start)
+        }
+
+        fn try_splice(
+            &mut self,
+            at: usize,
+            len: usize,
+            data: &[u8],
+        ) -> core::result::Result<(), ()> {
+            let used = self.vec.len() - self.start;
+            let new_len = spliced_len(used, at, len, data)?;
+            self.vec.resize(self.start + used.max(new_len), 0);
+            splice_at(&mut self.vec[self.start..], used, at, len, data);
+            self.vec.truncate(self.start + new_len);
+            Ok(())
+        }
+
+        fn release(self) -> core::result::Result<Self::Output, ()> {
+            let ExtendVec { vec, start } = self;
+            Ok(&mut vec[start..])
+        }
+    }
+
+    impl<'a> ResettableFlavor for ExtendVec<'a> {
+        fn finish(&mut self) -> core::result::Result<&[u8], ()> {
+            Ok(&self.vec[self.start..])
+        }
+
+        fn reset(&mut self) -> core::result::Result<(), ()> {
+            self.vec.truncate(self.start);
+            Ok(())
+        }
+    }
+
+    impl<'a> Index<usize> for ExtendVec<'a> {
+        type Output = u8;
+
+        fn index(&self, idx: usize) -> &u8 {
+            &self.vec[self.start + idx]
+        }
+    }
+
+    impl<'a> IndexMut<usize> for ExtendVec<'a> {
+        fn index_mut(&mut self, idx: usize) -> &mut u8 {
+            &mut self.vec[self.start + idx]
+        }
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Modification Flavors
 ////////////////////////////////////////////////////////////////////////////////
@@ -361,9 +802,15 @@ where
     B: SerFlavor + IndexMut<usize, Output = u8>,
 {
     flav: B,
-    cobs: EncoderState,
+    /// Index of the code byte for the current block, in the storage flavor
+    code_idx: usize,
+    /// Number of non-zero bytes written since the current code byte
+    run: usize,
 }
 
+/// The longest run of non-zero bytes a single COBS code byte can describe
+const COBS_MAX_RUN: usize = 254;
+
 impl<B> Cobs<B>
 where
     B: SerFlavor + IndexMut<usize, Output = u8>,
@@ -374,9 +821,20 @@ where
         bee.try_push(0).map_err(|_| Error::SerializeBufferFull)?;
         Ok(Self {
             flav: bee,
-            cobs: EncoderState::default(),
+            code_idx: 0,
+            run: 0,
         })
     }
+
+    /// Write the code byte of the current block, and start a new block with
+    /// a placeholder code byte.
+    #[inline(always)]
+    fn close_block(&mut self, code: u8) -> core::result::Result<(), ()> {
+        self.flav[self.code_idx] = code;
+        self.code_idx += self.run + 1;
+        self.run = 0;
+        self.flav.try_push(0)
+    }
 }
 
 impl<'a, B> SerFlavor for Cobs<B>
@@ -385,27 +843,321 @@ where
 {
     type Output = <B as SerFlavor>::Output;
 
+    /// Copies each run of non-zero bytes to the storage flavor with a single
+    /// `try_extend()`, only stopping at zero bytes and full 254 byte blocks.
+    fn try_extend(&mut self, mut data: &[u8]) -> core::result::Result<(), ()> {
+        while !data.is_empty() {
+            let room = COBS_MAX_RUN - self.run;
+            let chunk = &data[..room.min(data.len())];
+
+            match find_zero(chunk) {
+                Some(zero) => {
+                    self.flav.try_extend(&chunk[..zero])?;
+                    self.run += zero;
+                    self.close_block((self.run + 1) as u8)?;
+                    data = &data[zero + 1..];
+                }
+                None => {
+                    self.flav.try_extend(chunk)?;
+                    self.run += chunk.len();
+                    if self.run == COBS_MAX_RUN {
+                        self.close_block(0xFF)?;
+                    }
+                    data = &data[chunk.len()..];
+                }
+            }
+        }
+        Ok(())
+    }
+
     #[inline(always)]
     fn try_push(&mut self, data: u8) -> core::result::Result<(), ()> {
-        use PushResult::*;
-        match self.cobs.push(data) {
-            AddSingle(n) => self.flav.try_push(n),
-            ModifyFromStartAndSkip((idx, mval)) => {
-                self.flav[idx] = mval;
-                self.flav.try_push(0)
+        if data == 0 {
+            return self.close_block((self.run + 1) as u8);
+        }
+
+        self.flav.try_push(data)?;
+        self.run += 1;
+        if self.run == COBS_MAX_RUN {
+            self.close_block(0xFF)?;
+        }
+        Ok(())
+    }
+
+    fn release(mut self) -> core::result::Result<Self::Output, ()> {
+        self.flav[self.code_idx] = (self.run + 1) as u8;
+        self.flav.try_push(0)?;
+        self.flav.release()
+    }
+}
+
+impl<B> ResettableFlavor for Cobs<B>
+where
+    B: ResettableFlavor + IndexMut<usize, Output = u8>,
+{
+    fn finish(&mut self) -> core::result::Result<&[u8], ()> {
+        self.flav[self.code_idx] = (self.run + 1) as u8;
+        self.flav.try_push(0)?;
+        self.flav.finish()
+    }
+
+    fn reset(&mut self) -> core::result::Result<(), ()> {
+        self.flav.reset()?;
+        self.flav.try_push(0)?;
+        self.code_idx = 0;
+        self.run = 0;
+        Ok(())
+    }
+}
+
+////////////////////////////////////////
+// CRC
+////////////////////////////////////////
+
+/// The `Crc` flavor computes a checksum of the serialized data while it is being written,
+/// and appends it to the output. The checksum is stored in little endian byte order.
+///
+/// The algorithm defaults to CRC-32, and can be any of the algorithms in the
+/// [`crc`](crate::crc) module. Messages can be verified and deserialized with
+/// [`from_bytes_crc`](crate::from_bytes_crc).
+///
+/// When wrapped around a `Cobs` flavor, as `Crc<Cobs<B>>`, the checksum is COBS encoded
+/// along with the message.
+pub struct Crc<B, C = Crc32>
+where
+    B: SerFlavor,
+    C: CrcAlgorithm,
+{
+    flav: B,
+    crc: C,
+}
+
+impl<B, C> Crc<B, C>
+where
+    B: SerFlavor,
+    C: CrcAlgorithm,
+{
+    /// Create a new Crc modifier Flavor.
+    pub fn new(bee: B) -> Self {
+        Self {
+            flav: bee,
+            crc: C::default(),
+        }
+    }
+}
+
+impl<B, C> SerFlavor for Crc<B, C>
+where
+    B: SerFlavor,
+    C: CrcAlgorithm,
+{
+    type Output = <B as SerFlavor>::Output;
+
+    #[inline(always)]
+    fn try_extend(&mut self, data: &[u8]) -> core::result::Result<(), ()> {
+        self.flav.try_extend(data)?;
+        self.crc.update(data);
+        Ok(())
+    }
+
+    #[inline(always)]
+    fn try_push(&mut self, data: u8) -> core::result::Result<(), ()> {
+        self.flav.try_push(data)?;
+        self.crc.update(&[data]);
+        Ok(())
+    }
+
+    fn release(mut self) -> core::result::Result<Self::Output, ()> {
+        self.flav.try_extend(self.crc.finish().as_ref())?;
+        self.flav.release()
+    }
+}
+
+impl<B, C> ResettableFlavor for Crc<B, C>
+where
+    B: ResettableFlavor,
+    C: CrcAlgorithm,
+{
+    fn finish(&mut self) -> core::result::Result<&[u8], ()> {
+        self.flav.try_extend(self.crc.finish().as_ref())?;
+        self.flav.finish()
+    }
+
+    fn reset(&mut self) -> core::result::Result<(), ()> {
+        self.crc = C::default();
+        self.flav.reset()
+    }
+}
+
+////////////////////////////////////////
+// Length Prefix
+////////////////////////////////////////
+
+/// The length header written by the [`LengthPrefixed`] flavor
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub enum LengthHeader {
+    /// A little endian `u16`
+    U16,
+    /// A little endian `u32`
+    U32,
+    /// A varint, always taking as many bytes as the given maximum message length does.
+    /// Shorter lengths are padded with continuation bytes, e.g. a length of `5` with a
+    /// maximum of `1000` is written as `[0x85, 0x00]`.
+    Varint(usize),
+}
+
+impl LengthHeader {
+    /// The number of bytes taken by the header
+    pub const fn size(&self) -> usize {
+        match self {
+            LengthHeader::U16 => 2,
+            LengthHeader::U32 => 4,
+            LengthHeader::Varint(max_len) => VarintUsize(*max_len).varint_len(),
+        }
+    }
+
+    /// The largest message length the header can hold
+    pub const fn max_len(&self) -> usize {
+        match self {
+            LengthHeader::U16 => u16::max_value() as usize,
+            // Truncates to `usize::max_value()` on 16-bit targets
+            LengthHeader::U32 => u32::max_value() as usize,
+            LengthHeader::Varint(max_len) => *max_len,
+        }
+    }
+}
+
+/// The `LengthPrefixed` flavor prepends the length of the serialized data to the output,
+/// as described by a [`LengthHeader`].
+///
+/// Space for the header is reserved in the storage flavor up front, the data is serialized
+/// directly after it, and the header is filled in when the flavor is released. This avoids
+/// serializing into a scratch buffer just to learn the length of a message. The storage
+/// flavor must be empty when the `LengthPrefixed` flavor is created.
+///
+/// Messages can be deserialized with
+/// [`take_from_bytes_length_prefixed`](crate::take_from_bytes_length_prefixed).
+///
+/// ```rust
+/// use postcard::{
+///     serialize_with_flavor,
+///     flavors::{LengthHeader, LengthPrefixed, Slice},
+/// };
+///
+/// let buffer = &mut [0u8; 32];
+/// let res = serialize_with_flavor::<str, LengthPrefixed<Slice>, &mut [u8]>(
+///     "Hi!",
+///     LengthPrefixed::try_new(Slice::new(buffer), LengthHeader::U16).unwrap(),
+/// ).unwrap();
+///
+/// assert_eq!(res, &[0x04, 0x00, 0x03, b'H', b'i', b'!']);
+/// ```
+pub struct LengthPrefixed<B>
+where
+    B: SerFlavor + IndexMut<usize, Output = u8>,
+{
+    flav: B,
+    header: LengthHeader,
+    len: usize,
+}
+
+impl<B> LengthPrefixed<B>
+where
+    B: SerFlavor + IndexMut<usize, Output = u8>,
+{
+    /// Create a new LengthPrefixed modifier Flavor. If there is insufficient space
+    /// to reserve the header, the method will return an Error
+    pub fn try_new(mut bee: B, header: LengthHeader) -> Result<Self> {
+        for _ in 0..header.size() {
+            bee.try_push(0).map_err(|_| Error::SerializeBufferFull)?;
+        }
+        Ok(Self {
+            flav: bee,
+            header,
+            len: 0,
+        })
+    }
+
+    /// Fill in the reserved header with the length of the data written so far
+    fn write_header(&mut self) -> core::result::Result<(), ()> {
+        if self.len > self.header.max_len() {
+            return Err(());
+        }
+
+        match self.header {
+            LengthHeader::U16 | LengthHeader::U32 => {
+                let bytes = (self.len as u64).to_le_bytes();
+                for (i, byte) in bytes[..self.header.size()].iter().enumerate() {
+                    self.flav[i] = *byte;
+                }
             }
-            ModifyFromStartAndPushAndSkip((idx, mval, nval)) => {
-                self.flav[idx] = mval;
-                self.flav.try_push(nval)?;
-                self.flav.try_push(0)
+            LengthHeader::Varint(_) => {
+                let last = self.header.size() - 1;
+                for i in 0..=last {
+                    let group = ((self.len >> (7 * i)) & 0x7F) as u8;
+                    self.flav[i] = if i == last { group } else { group | 0x80 };
+                }
             }
         }
+        Ok(())
+    }
+}
+
+impl<B> SerFlavor for LengthPrefixed<B>
+where
+    B: SerFlavor + IndexMut<usize, Output = u8>,
+{
+    type Output = <B as SerFlavor>::Output;
+
+    #[inline(always)]
+    fn try_extend(&mut self, data: &[u8]) -> core::result::Result<(), ()> {
+        self.flav.try_extend(data)?;
+        self.len += data.len();
+        Ok(())
+    }
+
+    #[inline(always)]
+    fn try_push(&mut self, data: u8) -> core::result::Result<(), ()> {
+        self.flav.try_push(data)?;
+        self.len += 1;
+        Ok(())
+    }
+
+    fn written(&self) -> Option<usize> {
+        self.flav.written()
+    }
+
+    fn try_splice(&mut self, at: usize, len: usize, data: &[u8]) -> core::result::Result<(), ()> {
+        // Never move the header
+        if at < self.header.size() {
+            return Err(());
+        }
+        self.flav.try_splice(at, len, data)?;
+        self.len = self.len + data.len() - len;
+        Ok(())
     }
 
     fn release(mut self) -> core::result::Result<Self::Output, ()> {
-        let (idx, mval) = self.cobs.finalize();
-        self.flav[idx] = mval;
-        self.flav.try_push(0)?;
+        self.write_header()?;
         self.flav.release()
     }
 }
+
+impl<B> ResettableFlavor for LengthPrefixed<B>
+where
+    B: ResettableFlavor + IndexMut<usize, Output = u8>,
+{
+    fn finish(&mut self) -> core::result::Result<&[u8], ()> {
+        self.write_header()?;
+        self.flav.finish()
+    }
+
+    fn reset(&mut self) -> core::result::Result<(), ()> {
+        self.flav.reset()?;
+        for _ in 0..self.header.size() {
+            self.flav.try_push(0)?;
+        }
+        self.len = 0;
+        Ok(())
+    }
+}
@@ -1,6 +1,7 @@
 use serde::Serialize;
+use crate::crc::CrcAlgorithm;
 use crate::error::{Error, Result};
-use crate::ser::flavors::{Cobs, SerFlavor, Slice};
+use crate::ser::flavors::{Cobs, Crc, SerFlavor, Size, Slice};
 
 #[cfg(feature = "heapless")]
 use crate::ser::flavors::HVec;
@@ -14,7 +15,10 @@ use crate::ser::flavors::StdVec;
 #[cfg(feature = "alloc")]
 use crate::ser::flavors::AllocVec;
 
-#[cfg(feature = "alloc")]
+#[cfg(any(feature = "alloc", feature = "use-std"))]
+use crate::ser::flavors::ExtendVec;
+
+#[cfg(any(feature = "alloc", feature = "use-std"))]
 extern crate alloc;
 
 use crate::ser::serializer::Serializer;
@@ -60,6 +64,29 @@ where
     )
 }
 
+/// Serialize a `T` to the given slice, followed by a checksum of the serialized data,
+/// computed with the CRC algorithm `C` (see the [`crc`](crate::crc) module).
+///
+/// ## Example
+///
+/// ```rust
+/// use postcard::{crc::Crc16Ccitt, from_bytes_crc, to_slice_crc};
+/// let mut buf = [0u8; 32];
+///
+/// let used = to_slice_crc::<_, Crc16Ccitt>(b"123456789", &mut buf).unwrap();
+/// assert_eq!(used, &[b'1', b'2', b'3', b'4', b'5', b'6', b'7', b'8', b'9', 0xB1, 0x29]);
+///
+/// let out: [u8; 9] = from_bytes_crc::<_, Crc16Ccitt>(used).unwrap();
+/// assert_eq!(&out, b"123456789");
+/// ```
+pub fn to_slice_crc<'a, 'b, T, C>(value: &'b T, buf: &'a mut [u8]) -> Result<&'a mut [u8]>
+where
+    T: Serialize + ?Sized,
+    C: CrcAlgorithm,
+{
+    serialize_with_flavor::<T, Crc<Slice<'a>, C>, &'a mut [u8]>(value, Crc::new(Slice::new(buf)))
+}
+
 /// Serialize a `T` to the given slice, with the resulting slice containing
 /// data in a serialized format.
 ///
@@ -68,6 +95,9 @@ where
 /// 1. A slice that contains the serialized message
 /// 2. A slice that contains the unused portion of the given buffer
 ///
+/// Sequences and maps of unknown length have their length written once they end, so a
+/// buffer of the size returned by [`serialized_size()`] is always large enough.
+///
 /// ## Example
 ///
 /// ```rust
@@ -257,6 +287,106 @@ where
     )
 }
 
+/// Serialize a `T` to the end of an existing `Vec<u8>`, keeping its contents. Requires
+/// the `alloc` or `use-std` feature.
+///
+/// Returns the appended portion of the `Vec`. Reusing one `Vec` for many messages avoids
+/// a fresh allocation, and the reallocations as it grows, for each of them. If
+/// serialization fails, the `Vec` is truncated back to its original length.
+///
+/// ## Example
+///
+/// ```rust
+/// use postcard::to_extend;
+///
+/// let mut buf = Vec::with_capacity(64);
+///
+/// let ser = to_extend(&true, &mut buf).unwrap();
+/// assert_eq!(ser, &[0x01]);
+///
+/// let ser = to_extend("Hi!", &mut buf).unwrap();
+/// assert_eq!(ser, &[0x03, b'H', b'i', b'!']);
+/// assert_eq!(buf.as_slice(), &[0x01, 0x03, b'H', b'i', b'!']);
+///
+/// // Clear the buffer for the next batch, keeping its allocation
+/// buf.clear();
+/// ```
+#[cfg(any(feature = "alloc", feature = "use-std"))]
+pub fn to_extend<'a, T>(value: &T, vec: &'a mut alloc::vec::Vec<u8>) -> Result<&'a mut [u8]>
+where
+    T: Serialize + ?Sized,
+{
+    let start = vec.len();
+    match serialize_with_flavor::<T, ExtendVec, &mut [u8]>(value, ExtendVec::new(vec)) {
+        Ok(_) => Ok(&mut vec[start..]),
+        Err(e) => {
+            vec.truncate(start);
+            Err(e)
+        }
+    }
+}
+
+/// Serialize and COBS encode a `T` to the end of an existing `Vec<u8>`, keeping its
+/// contents. Requires the `alloc` or `use-std` feature.
+///
+/// The terminating sentinel `0x00` byte is included in the output. Returns the appended
+/// portion of the `Vec`, see [`to_extend`] for details.
+///
+/// ## Example
+///
+/// ```rust
+/// use postcard::to_extend_cobs;
+///
+/// let mut buf = Vec::new();
+/// to_extend_cobs(&true, &mut buf).unwrap();
+/// to_extend_cobs("Hi!", &mut buf).unwrap();
+/// assert_eq!(buf.as_slice(), &[0x02, 0x01, 0x00, 0x05, 0x03, b'H', b'i', b'!', 0x00]);
+/// ```
+#[cfg(any(feature = "alloc", feature = "use-std"))]
+pub fn to_extend_cobs<'a, T>(value: &T, vec: &'a mut alloc::vec::Vec<u8>) -> Result<&'a mut [u8]>
+where
+    T: Serialize + ?Sized,
+{
+    let start = vec.len();
+    let res = Cobs::try_new(ExtendVec::new(vec))
+        .and_then(|flavor| serialize_with_flavor::<T, Cobs<ExtendVec>, &mut [u8]>(value, flavor));
+    match res {
+        Ok(_) => Ok(&mut vec[start..]),
+        Err(e) => {
+            vec.truncate(start);
+            Err(e)
+        }
+    }
+}
+
+/// Compute the exact number of bytes needed to serialize a `T`, without writing
+/// the serialized data anywhere.
+///
+/// The result is the length of the output of `to_slice`, `to_vec`, `to_stdvec` or
+/// `to_allocvec` for the same value. It does not include any COBS encoding overhead.
+///
+/// ## Example
+///
+/// ```rust
+/// use postcard::{serialized_size, to_slice};
+///
+/// assert_eq!(serialized_size(&true).unwrap(), 1);
+/// assert_eq!(serialized_size("Hi!").unwrap(), 4);
+///
+/// let data: &[u8] = &[0x01u8; 200];
+/// let size = serialized_size(data).unwrap();
+/// assert_eq!(size, 202);
+///
+/// let mut buf = [0u8; 256];
+/// assert_eq!(to_slice(data, &mut buf).unwrap().len(), size);
+/// ```
+pub fn serialized_size<T>(value: &T) -> Result<usize>
+where
+    T: Serialize + ?Sized,
+{
+    serialize_with_flavor::<T, Size, usize>(value, Size::default())
+}
+
 /// `serialize_with_flavor()` has three generic parameters, `T, F, O`.
 ///
 /// * `T`: This is the type that is being serialized
@@ -435,6 +565,295 @@ mod test {
         }
     }
 
+    #[test]
+    fn usize_varint_encode_boundaries() {
+        let mut buf = VarintUsize::new_buf();
+
+        assert_eq!(&[0x00], VarintUsize(0).to_buf(&mut buf));
+        assert_eq!(&[0x7F], VarintUsize(0x7F).to_buf(&mut buf));
+        assert_eq!(&[0x80, 0x01], VarintUsize(0x80).to_buf(&mut buf));
+        assert_eq!(&[0xFF, 0x7F], VarintUsize(0x3FFF).to_buf(&mut buf));
+        assert_eq!(&[0x80, 0x80, 0x01], VarintUsize(0x4000).to_buf(&mut buf));
+        assert_eq!(
+            &[0xFF, 0xFF, 0xFF, 0xFF, 0x0F],
+            VarintUsize(0xFFFF_FFFF).to_buf(&mut buf)
+        );
+
+        // Compare against a reference decode around every power of two
+        let mut val = 1usize;
+        while val != 0 {
+            for probe in &[val - 1, val, val | (val >> 1)] {
+                let used = VarintUsize(*probe).to_buf(&mut buf);
+                let (last, rest) = used.split_last().unwrap();
+                assert_eq!(last & 0x80, 0);
+                assert!(rest.iter().all(|b| b & 0x80 != 0));
+                let out = used
+                    .iter()
+                    .rev()
+                    .fold(0usize, |acc, b| (acc << 7) | (b & 0x7F) as usize);
+                assert_eq!(*probe, out);
+            }
+            val <<= 1;
+        }
+    }
+
+    #[test]
+    fn usize_varint_len() {
+        let mut buf = VarintUsize::new_buf();
+        for val in &[0, 1, 0x7F, 0x80, 0x3FFF, 0x4000, 0x1F_FFFF, 0x20_0000, usize::max_value()] {
+            let varint = VarintUsize(*val);
+            assert_eq!(varint.varint_len(), varint.to_buf(&mut buf).len());
+        }
+    }
+
+    #[test]
+    fn size_matches_output() {
+        let input: &[u8] = &[0xAA; 300];
+        let output: Vec<u8, 512> = to_vec(input).unwrap();
+        assert_eq!(serialized_size(input).unwrap(), output.len());
+        assert_eq!(serialized_size(input).unwrap(), 302);
+
+        let input = (1u8, 10u32, "Hello!");
+        let output: Vec<u8, 128> = to_vec(&input).unwrap();
+        assert_eq!(serialized_size(&input).unwrap(), output.len());
+
+        let input = DataEnum::Chi {
+            a: 0x0F,
+            b: 0xC7C7C7C7,
+        };
+        let output: Vec<u8, 8> = to_vec(&input).unwrap();
+        assert_eq!(serialized_size(&input).unwrap(), output.len());
+
+        assert_eq!(serialized_size(&()).unwrap(), 0);
+    }
+
+    /// Serializes the even numbers below `.0` as a sequence of unknown length
+    struct Evens(u32);
+
+    impl Serialize for Evens {
+        fn serialize<S>(&self, s: S) -> core::result::Result<S::Ok, S::Error>
+        where
+            S: serde::Serializer,
+        {
+            s.collect_seq((0..self.0).filter(|i| i % 2 == 0))
+        }
+    }
+
+    /// Serializes each `Evens` as a map entry of unknown length, keyed by its index
+    struct Nested<'a>(&'a [u32]);
+
+    impl<'a> Serialize for Nested<'a> {
+        fn serialize<S>(&self, s: S) -> core::result::Result<S::Ok, S::Error>
+        where
+            S: serde::Serializer,
+        {
+            s.collect_map(
+                self.0
+                    .iter()
+                    .enumerate()
+                    .filter(|(_, n)| **n != 0)
+                    .map(|(i, n)| (i as u8, Evens(*n))),
+            )
+        }
+    }
+
+    #[test]
+    fn unknown_length() {
+        use crate::flavors::{ExtendHVec, LengthHeader, LengthPrefixed};
+
+        for &n in &[0u32, 1, 20, 255, 256, 300] {
+            let known: Vec<u32, 256> = (0..n).step_by(2).fold(Vec::new(), |mut v, i| {
+                v.push(i).unwrap();
+                v
+            });
+            let expected: Vec<u8, 1024> = to_vec(&known).unwrap();
+
+            let output: Vec<u8, 1024> = to_vec(&Evens(n)).unwrap();
+            assert_eq!(output, expected);
+            assert_eq!(serialized_size(&Evens(n)).unwrap(), expected.len());
+
+            let mut buf = [0u8; 1024];
+            assert_eq!(to_slice(&Evens(n), &mut buf).unwrap(), expected.deref());
+            // No room is needed beyond the final output, even when the length slot grows
+            let exact = &mut buf[..expected.len()];
+            assert_eq!(to_slice(&Evens(n), exact).unwrap(), expected.deref());
+            let short = &mut buf[..expected.len() - 1];
+            assert_eq!(to_slice(&Evens(n), short), Err(Error::SerializeBufferFull));
+
+            let used = serialize_with_flavor::<_, LengthPrefixed<Slice>, _>(
+                &Evens(n),
+                LengthPrefixed::try_new(Slice::new(&mut buf), LengthHeader::U16).unwrap(),
+            )
+            .unwrap();
+            assert_eq!(&used[..2], &(expected.len() as u16).to_le_bytes());
+            assert_eq!(&used[2..], expected.deref());
+
+            let mut hvec: Vec<u8, 1024> = Vec::new();
+            hvec.push(0xAA).unwrap();
+            let used = serialize_with_flavor::<_, ExtendHVec<1024>, _>(
+                &Evens(n),
+                ExtendHVec::new(&mut hvec),
+            )
+            .unwrap();
+            assert_eq!(used, expected.deref());
+        }
+
+        // Nested sequences and maps of unknown length
+        let counts = [3, 0, 300, 1];
+        let output: Vec<u8, 1024> = to_vec(&Nested(&counts)).unwrap();
+        let mut expected: Vec<u8, 1024> = Vec::new();
+        expected.push(3).unwrap();
+        for &(i, n) in &[(0u8, 3), (2, 300), (3, 1)] {
+            expected.push(i).unwrap();
+            let inner: Vec<u8, 1024> = to_vec(&Evens(n)).unwrap();
+            expected.extend_from_slice(&inner).unwrap();
+        }
+        assert_eq!(output, expected);
+
+        // A single `u32` fits exactly the buffer `serialized_size()` asks for
+        assert_eq!(serialized_size(&Evens(2)).unwrap(), 5);
+        let mut buf = [0u8; 5];
+        assert_eq!(to_slice(&Evens(2), &mut buf).unwrap(), &[0x01, 0x00, 0x00, 0x00, 0x00]);
+        let mut buf = [0u8; 4];
+        assert_eq!(to_slice(&Evens(2), &mut buf), Err(Error::SerializeBufferFull));
+
+        // Modification flavors can't revisit the length
+        let mut buf = [0u8; 64];
+        assert_eq!(
+            to_slice_cobs(&Evens(2), &mut buf),
+            Err(Error::SerializeSeqLengthUnknown)
+        );
+    }
+
+    /// Serializes through `Display`, as many serde helpers do
+    struct Hex(u32);
+
+    impl Serialize for Hex {
+        fn serialize<S>(&self, s: S) -> core::result::Result<S::Ok, S::Error>
+        where
+            S: serde::Serializer,
+        {
+            s.collect_str(&format_args!("0x{:08X}", self.0))
+        }
+    }
+
+    /// Formats differently every time
+    struct Unstable(core::cell::Cell<usize>);
+
+    impl core::fmt::Display for Unstable {
+        fn fmt(&self, f: &mut core::fmt::Formatter) -> core::fmt::Result {
+            self.0.set(self.0.get() + 1);
+            write!(f, "{}", "x".repeat(self.0.get()))
+        }
+    }
+
+    #[test]
+    fn collect_str() {
+        let output: Vec<u8, 32> = to_vec(&(Hex(0xC0FFEE), 7u8)).unwrap();
+        let expected: Vec<u8, 32> = to_vec(&("0x00C0FFEE", 7u8)).unwrap();
+        assert_eq!(output, expected);
+        assert_eq!(serialized_size(&Hex(1)).unwrap(), 11);
+
+        let mut buf = [0u8; 32];
+        let output = to_slice_cobs(&Hex(0x100), &mut buf).unwrap();
+        let mut expected = [0u8; 32];
+        assert_eq!(output, to_slice_cobs("0x00000100", &mut expected).unwrap());
+
+        let mut buf = [0u8; 8];
+        assert_eq!(to_slice(&Hex(1), &mut buf), Err(Error::SerializeBufferFull));
+
+        let mut ser = Serializer::new(HVec::<32>::default());
+        let unstable = Unstable(core::cell::Cell::new(0));
+        assert_eq!(
+            serde::Serializer::collect_str(&mut ser, &unstable),
+            Err(Error::CollectStrError)
+        );
+    }
+
+    #[test]
+    fn reusable_flavors() {
+        use crate::crc::Crc16Ccitt;
+        use crate::flavors::{Crc, LengthHeader, LengthPrefixed, ResettableFlavor};
+
+        let messages: &[&[u8]] = &[b"", &[0x00, 0x01], &[0x55; 300], b"Hi!"];
+
+        let mut ser = Serializer::new(Crc::<_, Crc16Ccitt>::new(
+            Cobs::try_new(HVec::<512>::default()).unwrap(),
+        ));
+        for msg in messages {
+            msg.serialize(&mut ser).unwrap();
+            let expected: Vec<u8, 512> = serialize_with_flavor(
+                msg,
+                Crc::<_, Crc16Ccitt>::new(Cobs::try_new(HVec::default()).unwrap()),
+            )
+            .unwrap();
+            assert_eq!(ser.finish().unwrap(), expected.deref());
+            ser.reset().unwrap();
+        }
+
+        // Flavors can also be passed by reference
+        let mut buf = [0u8; 512];
+        let mut flavor = LengthPrefixed::try_new(Slice::new(&mut buf), LengthHeader::U16).unwrap();
+        for msg in messages {
+            let used = serialize_with_flavor::<_, &mut LengthPrefixed<Slice>, _>(msg, &mut flavor)
+                .unwrap();
+            let body: Vec<u8, 512> = to_vec(msg).unwrap();
+            assert_eq!(&used[..2], &(body.len() as u16).to_le_bytes());
+            assert_eq!(&used[2..], body.deref());
+            flavor.reset().unwrap();
+        }
+    }
+
+    #[test]
+    fn extend_hvec() {
+        use crate::flavors::ExtendHVec;
+
+        let mut buf: Vec<u8, 32> = Vec::new();
+        buf.extend_from_slice(&[0xAA, 0xBB]).unwrap();
+
+        let used = serialize_with_flavor::<_, Cobs<ExtendHVec<32>>, _>(
+            &(0u8, 5u8),
+            Cobs::try_new(ExtendHVec::new(&mut buf)).unwrap(),
+        )
+        .unwrap();
+        assert_eq!(used, &[0x01, 0x02, 0x05, 0x00]);
+        assert_eq!(buf.deref(), &[0xAA, 0xBB, 0x01, 0x02, 0x05, 0x00]);
+
+        let res = serialize_with_flavor::<_, ExtendHVec<32>, _>(
+            &[0u8; 27][..],
+            ExtendHVec::new(&mut buf),
+        );
+        assert_eq!(res, Err(Error::SerializeBufferFull));
+    }
+
+    #[cfg(any(feature = "alloc", feature = "use-std"))]
+    #[test]
+    fn extend_vec() {
+        extern crate alloc;
+
+        /// Serializes some data, then fails
+        struct Failing;
+
+        impl Serialize for Failing {
+            fn serialize<S>(&self, s: S) -> core::result::Result<S::Ok, S::Error>
+            where
+                S: serde::Serializer,
+            {
+                use serde::ser::{Error, SerializeTuple};
+                let mut tup = s.serialize_tuple(2)?;
+                tup.serialize_element(&0x1234_5678u32)?;
+                Err(S::Error::custom("failed"))
+            }
+        }
+
+        let mut buf = alloc::vec::Vec::new();
+        assert_eq!(to_extend(&0x0102u16, &mut buf).unwrap(), &[0x02, 0x01]);
+        assert_eq!(to_extend(&Failing, &mut buf), Err(Error::SerdeSerCustom));
+        assert_eq!(to_extend_cobs(&Failing, &mut buf), Err(Error::SerdeSerCustom));
+        assert_eq!(to_extend_cobs(&0x0100u16, &mut buf).unwrap(), &[0x01, 0x02, 0x01, 0x00]);
+        assert_eq!(buf, &[0x02, 0x01, 0x01, 0x02, 0x01, 0x00]);
+    }
+
     #[allow(dead_code)]
     #[derive(Serialize)]
     enum BasicEnum {
@@ -578,6 +997,101 @@ mod test {
         assert_eq!(&[0x04, 0x01, 0x05, 0x02, 0x06, 0x03, 0x07, 0x04, 0x08], output.deref());
     }
 
+    /// COBS encode with the byte-at-a-time encoder from the `cobs` crate
+    fn reference_cobs(data: &[u8]) -> Vec<u8, 2048> {
+        use cobs::{EncoderState, PushResult};
+
+        let mut out: Vec<u8, 2048> = Vec::new();
+        out.push(0).unwrap();
+        let mut state = EncoderState::default();
+        for byte in data {
+            match state.push(*byte) {
+                PushResult::AddSingle(n) => out.push(n).unwrap(),
+                PushResult::ModifyFromStartAndSkip((idx, mval)) => {
+                    out[idx] = mval;
+                    out.push(0).unwrap();
+                }
+                PushResult::ModifyFromStartAndPushAndSkip((idx, mval, nval)) => {
+                    out[idx] = mval;
+                    out.push(nval).unwrap();
+                    out.push(0).unwrap();
+                }
+            }
+        }
+        let (idx, mval) = state.finalize();
+        out[idx] = mval;
+        out.push(0).unwrap();
+        out
+    }
+
+    #[test]
+    fn cobs_bulk_matches_bytewise() {
+        let mut data = [0u8; 1200];
+        let cases = &[
+            (0, 0),
+            (0, 1),
+            (0, 253),
+            (0, 254),
+            (0, 255),
+            (0, 1200),
+            (1, 10),
+            (2, 600),
+            (7, 1200),
+            (254, 1200),
+            (255, 1200),
+            (300, 1000),
+        ];
+        for (zero_every, len) in cases {
+            for (i, byte) in data.iter_mut().enumerate() {
+                *byte = if *zero_every != 0 && i % zero_every == zero_every - 1 {
+                    0
+                } else {
+                    (i % 250) as u8 + 1
+                };
+            }
+            let input = &data[..*len];
+            let expected = reference_cobs(input);
+
+            // `&[u8]` goes through `try_extend`, after its length prefix
+            let mut with_len: Vec<u8, 1300> = Vec::new();
+            let mut buf = VarintUsize::new_buf();
+            with_len
+                .extend_from_slice(VarintUsize(input.len()).to_buf(&mut buf))
+                .unwrap();
+            with_len.extend_from_slice(input).unwrap();
+            let expected_with_len = reference_cobs(&with_len);
+            let output: Vec<u8, 2048> = to_vec_cobs(input).unwrap();
+            assert_eq!(output, expected_with_len);
+
+            // Each byte of a tuple goes through `try_push`
+            let mut flavor = Cobs::try_new(HVec::<2048>::default()).unwrap();
+            for byte in input {
+                flavor.try_push(*byte).unwrap();
+            }
+            assert_eq!(flavor.release().unwrap(), expected);
+
+            // Arbitrary mixes of both
+            let mut flavor = Cobs::try_new(HVec::<2048>::default()).unwrap();
+            for chunk in input.chunks(37) {
+                flavor.try_extend(&chunk[..chunk.len() / 2]).unwrap();
+                for byte in &chunk[chunk.len() / 2..] {
+                    flavor.try_push(*byte).unwrap();
+                }
+            }
+            assert_eq!(flavor.release().unwrap(), expected);
+        }
+    }
+
+    #[test]
+    fn cobs_buffer_full() {
+        let mut buf = [0u8; 8];
+        assert_eq!(
+            to_slice_cobs(&[1u8; 6][..], &mut buf),
+            Err(Error::SerializeBufferFull)
+        );
+        assert_eq!(to_slice_cobs(&[1u8; 5][..], &mut buf).unwrap().len(), 8);
+    }
+
     #[test]
     fn cobs_test() {
         let message = "hElLo";
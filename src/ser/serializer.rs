@@ -1,7 +1,8 @@
 use serde::{ser, Serialize};
 
+use crate::bulk;
 use crate::error::{Error, Result};
-use crate::ser::flavors::SerFlavor;
+use crate::ser::flavors::{ResettableFlavor, SerFlavor};
 use crate::varint::VarintUsize;
 
 /// A `serde` compatible serializer, generic over "Flavors" of serializing plugins.
@@ -21,6 +22,51 @@ where
     pub output: F,
 }
 
+impl<F> Serializer<F>
+where
+    F: SerFlavor,
+{
+    /// Create a new Serializer, writing to the given flavor
+    pub fn new(output: F) -> Self {
+        Serializer { output }
+    }
+}
+
+impl<F> Serializer<F>
+where
+    F: ResettableFlavor,
+{
+    /// Finalize the message serialized so far, and return the serialized bytes.
+    ///
+    /// Unlike [`serialize_with_flavor()`](crate::serialize_with_flavor), this
+    /// keeps the flavor, so that it can serialize another message after a call to
+    /// [`reset()`](Serializer::reset).
+    ///
+    /// ```rust
+    /// # #[cfg(feature = "heapless")] {
+    /// use postcard::{flavors::{Cobs, HVec}, Serializer};
+    /// use serde::Serialize;
+    ///
+    /// let mut ser = Serializer::new(Cobs::try_new(HVec::<32>::default()).unwrap());
+    ///
+    /// for value in &[0x01u16, 0x0203] {
+    ///     value.serialize(&mut ser).unwrap();
+    ///     let frame = ser.finish().unwrap();
+    ///     assert_eq!(frame, postcard::to_vec_cobs::<_, 32>(value).unwrap().as_ref());
+    ///     ser.reset().unwrap();
+    /// }
+    /// # }
+    /// ```
+    pub fn finish(&mut self) -> Result<&[u8]> {
+        self.output.finish().map_err(|_| Error::SerializeBufferFull)
+    }
+
+    /// Discard the output of the previous message, and prepare to serialize the next one
+    pub fn reset(&mut self) -> Result<()> {
+        self.output.reset().map_err(|_| Error::SerializeBufferFull)
+    }
+}
+
 impl<'a, F> ser::Serializer for &'a mut Serializer<F>
 where
     F: SerFlavor,
@@ -30,14 +76,14 @@ where
     type Error = Error;
 
     // Associated types for keeping track of additional state while serializing
-    // compound data structures like sequences and maps. In this case no
-    // additional state is required beyond what is already stored in the
-    // Serializer struct.
-    type SerializeSeq = Self;
+    // compound data structures like sequences and maps. Only sequences and maps
+    // need state beyond what is already stored in the Serializer struct, to
+    // back-patch their length when it is not known up front.
+    type SerializeSeq = SerializeCollection<'a, F>;
     type SerializeTuple = Self;
     type SerializeTupleStruct = Self;
     type SerializeTupleVariant = Self;
-    type SerializeMap = Self;
+    type SerializeMap = SerializeCollection<'a, F>;
     type SerializeStruct = Self;
     type SerializeStructVariant = Self;
 
@@ -177,10 +223,17 @@ where
             .map_err(|_| Error::SerializeBufferFull)
     }
 
-    fn serialize_newtype_struct<T>(self, _name: &'static str, value: &T) -> Result<()>
+    fn serialize_newtype_struct<T>(self, name: &'static str, value: &T) -> Result<()>
     where
         T: ?Sized + Serialize,
     {
+        if let Some((width, prefixed)) = bulk::lookup(name) {
+            return value.serialize(BulkSerializer {
+                output: &mut self.output,
+                width,
+                prefixed,
+            });
+        }
         value.serialize(self)
     }
 
@@ -201,10 +254,7 @@ where
     }
 
     fn serialize_seq(self, len: Option<usize>) -> Result<Self::SerializeSeq> {
-        self.output
-            .try_push_varint_usize(&VarintUsize(len.ok_or(Error::SerializeSeqLengthUnknown)?))
-            .map_err(|_| Error::SerializeBufferFull)?;
-        Ok(self)
+        SerializeCollection::begin(self, len)
     }
 
     fn serialize_tuple(self, _len: usize) -> Result<Self::SerializeTuple> {
@@ -233,10 +283,7 @@ where
     }
 
     fn serialize_map(self, len: Option<usize>) -> Result<Self::SerializeMap> {
-        self.output
-            .try_push_varint_usize(&VarintUsize(len.ok_or(Error::SerializeSeqLengthUnknown)?))
-            .map_err(|_| Error::SerializeBufferFull)?;
-        Ok(self)
+        SerializeCollection::begin(self, len)
     }
 
     fn serialize_struct(self, _name: &'static str, _len: usize) -> Result<Self::SerializeStruct> {
@@ -256,15 +303,104 @@ where
         Ok(self)
     }
 
-    fn collect_str<T: ?Sized>(self, _value: &T) -> Result<Self::Ok>
+    // The value is formatted twice: once to learn the length prefix, then again
+    // straight into the flavor, so no intermediate `String` is needed.
+    fn collect_str<T: ?Sized>(self, value: &T) -> Result<Self::Ok>
     where
         T: core::fmt::Display,
     {
-        unreachable!()
+        use core::fmt::Write;
+
+        let mut counter = CountWriter(0);
+        write!(counter, "{}", value).map_err(|_| Error::CollectStrError)?;
+        let len = counter.0;
+
+        self.output
+            .try_push_varint_usize(&VarintUsize(len))
+            .map_err(|_| Error::SerializeBufferFull)?;
+
+        let mut writer = FlavorWriter {
+            output: &mut self.output,
+            remaining: len,
+            full: false,
+        };
+        let res = write!(writer, "{}", value);
+        if writer.full {
+            return Err(Error::SerializeBufferFull);
+        }
+        match res {
+            Ok(()) if writer.remaining == 0 => Ok(()),
+            _ => Err(Error::CollectStrError),
+        }
     }
 }
 
-impl<'a, F> ser::SerializeSeq for &'a mut Serializer<F>
+/// The state of a sequence or map being serialized.
+///
+/// When the length is not known up front, a one byte slot is reserved instead, and the
+/// elements are counted. Once the collection ends, the count is written into the slot,
+/// which is grown if the count needs a longer varint, so that the output is the same as
+/// for a collection of known length. The elements are moved at most once, and the flavor
+/// needs no more room than the final output.
+///
+/// Back-patching needs a flavor that supports [`SerFlavor::try_splice()`], such as the
+/// storage flavors. For other flavors [`Error::SerializeSeqLengthUnknown`] is returned.
+pub struct SerializeCollection<'a, F>
+where
+    F: SerFlavor,
+{
+    ser: &'a mut Serializer<F>,
+    // Offset of the reserved length slot, and the number of elements so far
+    unknown: Option<(usize, usize)>,
+}
+
+impl<'a, F> SerializeCollection<'a, F>
+where
+    F: SerFlavor,
+{
+    fn begin(ser: &'a mut Serializer<F>, len: Option<usize>) -> Result<Self> {
+        let unknown = match len {
+            Some(len) => {
+                ser.output
+                    .try_push_varint_usize(&VarintUsize(len))
+                    .map_err(|_| Error::SerializeBufferFull)?;
+                None
+            }
+            None => {
+                let at = ser
+                    .output
+                    .written()
+                    .ok_or(Error::SerializeSeqLengthUnknown)?;
+                ser.output
+                    .try_push(0)
+                    .map_err(|_| Error::SerializeBufferFull)?;
+                Some((at, 0))
+            }
+        };
+        Ok(SerializeCollection { ser, unknown })
+    }
+
+    #[inline(always)]
+    fn count(&mut self) {
+        if let Some((_, ref mut count)) = self.unknown {
+            *count += 1;
+        }
+    }
+
+    fn finish(self) -> Result<()> {
+        if let Some((at, count)) = self.unknown {
+            let mut buf = VarintUsize::new_buf();
+            let used = VarintUsize(count).to_buf(&mut buf);
+            self.ser
+                .output
+                .try_splice(at, 1, used)
+                .map_err(|_| Error::SerializeBufferFull)?;
+        }
+        Ok(())
+    }
+}
+
+impl<'a, F> ser::SerializeSeq for SerializeCollection<'a, F>
 where
     F: SerFlavor,
 {
@@ -278,12 +414,13 @@ where
     where
         T: ?Sized + Serialize,
     {
-        value.serialize(&mut **self)
+        self.count();
+        value.serialize(&mut *self.ser)
     }
 
     // Close the sequence.
     fn end(self) -> Result<()> {
-        Ok(())
+        self.finish()
     }
 }
 
@@ -344,7 +481,7 @@ where
     }
 }
 
-impl<'a, F> ser::SerializeMap for &'a mut Serializer<F>
+impl<'a, F> ser::SerializeMap for SerializeCollection<'a, F>
 where
     F: SerFlavor,
 {
@@ -355,18 +492,19 @@ where
     where
         T: ?Sized + Serialize,
     {
-        key.serialize(&mut **self)
+        self.count();
+        key.serialize(&mut *self.ser)
     }
 
     fn serialize_value<T>(&mut self, value: &T) -> Result<()>
     where
         T: ?Sized + Serialize,
     {
-        value.serialize(&mut **self)
+        value.serialize(&mut *self.ser)
     }
 
     fn end(self) -> Result<()> {
-        Ok(())
+        self.finish()
     }
 }
 
@@ -407,3 +545,149 @@ where
         Ok(())
     }
 }
+
+/// Counts the bytes of formatted output, for `collect_str`
+struct CountWriter(usize);
+
+impl core::fmt::Write for CountWriter {
+    fn write_str(&mut self, s: &str) -> core::fmt::Result {
+        self.0 += s.len();
+        Ok(())
+    }
+}
+
+/// Writes formatted output to a flavor, for `collect_str`. Fails if the output is longer
+/// than the `remaining` bytes counted beforehand, or the flavor is full.
+struct FlavorWriter<'a, F>
+where
+    F: SerFlavor,
+{
+    output: &'a mut F,
+    remaining: usize,
+    full: bool,
+}
+
+impl<'a, F> core::fmt::Write for FlavorWriter<'a, F>
+where
+    F: SerFlavor,
+{
+    fn write_str(&mut self, s: &str) -> core::fmt::Result {
+        self.remaining = self
+            .remaining
+            .checked_sub(s.len())
+            .ok_or(core::fmt::Error)?;
+        self.output.try_extend(s.as_bytes()).map_err(|_| {
+            self.full = true;
+            core::fmt::Error
+        })
+    }
+}
+
+/// Writes the little-endian bytes of a `crate::bulk` sequence or array with a
+/// single `try_extend`. The only supported operation is `serialize_bytes`.
+struct BulkSerializer<'a, F>
+where
+    F: SerFlavor,
+{
+    output: &'a mut F,
+    width: usize,
+    prefixed: bool,
+}
+
+macro_rules! bulk_unsupported {
+    ($($method:ident($($arg:ty),*) -> $ret:ty;)*) => {
+        $(
+            fn $method(self, $(_: $arg),*) -> Result<$ret> {
+                Err(Error::WontImplement)
+            }
+        )*
+    };
+}
+
+impl<'a, F> ser::Serializer for BulkSerializer<'a, F>
+where
+    F: SerFlavor,
+{
+    type Ok = ();
+    type Error = Error;
+
+    type SerializeSeq = ser::Impossible<(), Error>;
+    type SerializeTuple = ser::Impossible<(), Error>;
+    type SerializeTupleStruct = ser::Impossible<(), Error>;
+    type SerializeTupleVariant = ser::Impossible<(), Error>;
+    type SerializeMap = ser::Impossible<(), Error>;
+    type SerializeStruct = ser::Impossible<(), Error>;
+    type SerializeStructVariant = ser::Impossible<(), Error>;
+
+    fn serialize_bytes(self, v: &[u8]) -> Result<()> {
+        if self.prefixed {
+            self.output
+                .try_push_varint_usize(&VarintUsize(v.len() / self.width))
+                .map_err(|_| Error::SerializeBufferFull)?;
+        }
+        self.output
+            .try_extend(v)
+            .map_err(|_| Error::SerializeBufferFull)
+    }
+
+    bulk_unsupported! {
+        serialize_bool(bool) -> ();
+        serialize_i8(i8) -> ();
+        serialize_i16(i16) -> ();
+        serialize_i32(i32) -> ();
+        serialize_i64(i64) -> ();
+        serialize_u8(u8) -> ();
+        serialize_u16(u16) -> ();
+        serialize_u32(u32) -> ();
+        serialize_u64(u64) -> ();
+        serialize_f32(f32) -> ();
+        serialize_f64(f64) -> ();
+        serialize_char(char) -> ();
+        serialize_str(&str) -> ();
+        serialize_none() -> ();
+        serialize_unit() -> ();
+        serialize_unit_struct(&'static str) -> ();
+        serialize_unit_variant(&'static str, u32, &'static str) -> ();
+        serialize_seq(Option<usize>) -> Self::SerializeSeq;
+        serialize_tuple(usize) -> Self::SerializeTuple;
+        serialize_tuple_struct(&'static str, usize) -> Self::SerializeTupleStruct;
+        serialize_tuple_variant(&'static str, u32, &'static str, usize) -> Self::SerializeTupleVariant;
+        serialize_map(Option<usize>) -> Self::SerializeMap;
+        serialize_struct(&'static str, usize) -> Self::SerializeStruct;
+        serialize_struct_variant(&'static str, u32, &'static str, usize) -> Self::SerializeStructVariant;
+    }
+
+    fn serialize_some<T>(self, _value: &T) -> Result<()>
+    where
+        T: ?Sized + Serialize,
+    {
+        Err(Error::WontImplement)
+    }
+
+    fn serialize_newtype_struct<T>(self, _name: &'static str, _value: &T) -> Result<()>
+    where
+        T: ?Sized + Serialize,
+    {
+        Err(Error::WontImplement)
+    }
+
+    fn serialize_newtype_variant<T>(
+        self,
+        _name: &'static str,
+        _variant_index: u32,
+        _variant: &'static str,
+        _value: &T,
+    ) -> Result<()>
+    where
+        T: ?Sized + Serialize,
+    {
+        Err(Error::WontImplement)
+    }
+
+    fn collect_str<T: ?Sized>(self, _value: &T) -> Result<()>
+    where
+        T: core::fmt::Display,
+    {
+        Err(Error::WontImplement)
+    }
+}
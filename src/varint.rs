@@ -12,19 +12,37 @@ pub struct VarintUsize(pub usize);
 pub type VarintBuf = [u8; VarintUsize::varint_usize_max()];
 
 impl VarintUsize {
+    /// Encode this value into the given buffer, returning the used portion.
+    ///
+    /// The encoded length is computed up front, so every byte is written without
+    /// a data-dependent branch, with a shortcut for the common single byte case.
+    #[inline]
     pub fn to_buf<'a, 'b>(&'a self, out: &'b mut VarintBuf) -> &'b mut [u8] {
-        let mut value = self.0;
-        for i in 0..Self::varint_usize_max() {
-            out[i] = (value & 0x7F) as u8;
-            value >>= 7;
-            if value != 0 {
-                out[i] |= 0x80;
-            } else {
-                return &mut out[..=i];
-            }
+        let value = self.0;
+        if value < 0x80 {
+            out[0] = value as u8;
+            return &mut out[..1];
         }
-        debug_assert_eq!(value, 0);
-        &mut out[..]
+
+        // Write every 7-bit group with the continuation bit set, then clear the
+        // continuation bit of the last used byte. The loop has a fixed trip count,
+        // so it is fully unrolled.
+        let len = self.varint_len();
+        for (i, byte) in out.iter_mut().enumerate() {
+            *byte = ((value >> (7 * i)) as u8) | 0x80;
+        }
+        out[len - 1] &= 0x7F;
+        &mut out[..len]
+    }
+
+    /// Number of bytes needed to encode this value, without encoding it
+    pub const fn varint_len(&self) -> usize {
+        const BITS_PER_VARINT_BYTE: usize = 7;
+
+        // A value of zero still takes one byte on the wire
+        let used_bits =
+            (core::mem::size_of::<usize>() * 8) - ((self.0 | 1).leading_zeros() as usize);
+        (used_bits + BITS_PER_VARINT_BYTE - 1) / BITS_PER_VARINT_BYTE
     }
 
     pub const fn new_buf() -> VarintBuf {
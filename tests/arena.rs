@@ -0,0 +1,100 @@
+#![cfg(feature = "derive")]
+
+use postcard::arena::{Arena, ArenaBytes, ArenaStr, ArenaVec};
+use postcard::{from_bytes_in, to_slice, DeserializeIn, Error};
+use serde::Serialize;
+
+#[derive(Serialize)]
+struct Entry<'a> {
+    key: &'a str,
+    tags: &'a [&'a str],
+    value: Option<u32>,
+}
+
+#[derive(DeserializeIn, Debug)]
+struct ArenaEntry<'a> {
+    key: ArenaStr<'a>,
+    tags: ArenaVec<'a, ArenaStr<'a>>,
+    value: Option<u32>,
+}
+
+#[derive(DeserializeIn, Debug, PartialEq)]
+struct Point(i16, i16);
+
+#[derive(DeserializeIn, Debug)]
+struct Batch<'a, T> {
+    id: u8,
+    items: ArenaVec<'a, T>,
+    blob: ArenaBytes<'a>,
+}
+
+#[test]
+fn derived() {
+    let mut buf = [0u8; 128];
+    let used = to_slice(
+        &(
+            7u8,
+            [
+                Entry {
+                    key: "alpha",
+                    tags: &["x", "yz"],
+                    value: Some(300),
+                },
+                Entry {
+                    key: "",
+                    tags: &[],
+                    value: None,
+                },
+            ]
+            .as_ref(),
+            &[0xAAu8, 0xBB][..],
+        ),
+        &mut buf,
+    )
+    .unwrap();
+
+    let mut storage = [0u8; 512];
+    let arena = Arena::new(&mut storage);
+    let batch: Batch<ArenaEntry> = from_bytes_in(used, &arena).unwrap();
+    // The input can be reused while the message is alive
+    buf.iter_mut().for_each(|b| *b = 0);
+
+    assert_eq!(batch.id, 7);
+    assert_eq!(batch.items.len(), 2);
+    assert_eq!(batch.items[0].key, "alpha");
+    assert_eq!(batch.items[0].tags, ["x", "yz"]);
+    assert_eq!(batch.items[0].value, Some(300));
+    assert_eq!(batch.items[1].key, "");
+    assert!(batch.items[1].tags.is_empty());
+    assert_eq!(batch.items[1].value, None);
+    assert_eq!(batch.blob, [0xAA, 0xBB]);
+
+    let used = to_slice(&[(1i16, -1i16), (-2, 2)][..], &mut buf).unwrap();
+    let points: ArenaVec<Point> = from_bytes_in(used, &arena).unwrap();
+    assert_eq!(points, [Point(1, -1), Point(-2, 2)]);
+}
+
+#[test]
+fn errors() {
+    let mut storage = [0u8; 16];
+    let arena = Arena::new(&mut storage);
+
+    let mut buf = [0u8; 64];
+    let used = to_slice(
+        &Entry {
+            key: "a key that does not fit",
+            tags: &[],
+            value: None,
+        },
+        &mut buf,
+    )
+    .unwrap();
+    assert_eq!(
+        from_bytes_in::<ArenaEntry>(used, &arena).unwrap_err(),
+        Error::DeserializeArenaFull
+    );
+    assert_eq!(
+        from_bytes_in::<ArenaEntry>(&used[..4], &arena).unwrap_err(),
+        Error::DeserializeUnexpectedEnd
+    );
+}
@@ -0,0 +1,167 @@
+#![cfg(feature = "derive")]
+
+use postcard::flavors::SerFlavor;
+use postcard::{from_bytes, serialize_with_flavor, to_slice, Error, FixedLayout};
+use serde::de::value::{self, BytesDeserializer, SeqDeserializer};
+use serde::{Deserialize, Serialize};
+
+#[derive(FixedLayout, Serialize, Deserialize, Debug, Clone, Copy, Default, PartialEq)]
+struct Vec3 {
+    x: f32,
+    y: f32,
+    z: f32,
+}
+
+#[derive(FixedLayout, Serialize, Deserialize, Debug, Clone, Copy, Default, PartialEq)]
+struct Status(u8, bool);
+
+#[derive(FixedLayout, Serialize, Deserialize, Debug, PartialEq)]
+struct Imu {
+    seq: u32,
+    timestamp_us: u64,
+    accel: Vec3,
+    gyro: [Vec3; 2],
+    temperature: i16,
+    status: Status,
+    raw: [u16; 3],
+}
+
+#[derive(Serialize, Deserialize, Debug, PartialEq)]
+struct Packet {
+    id: u8,
+    #[serde(with = "postcard::fixed")]
+    imu: Imu,
+    #[serde(with = "postcard::fixed")]
+    corrections: [Status; 2],
+}
+
+fn imu() -> Imu {
+    Imu {
+        seq: 0x0102_0304,
+        timestamp_us: 1_600_000_000_000_000,
+        accel: Vec3 {
+            x: 0.01,
+            y: -0.02,
+            z: 9.81,
+        },
+        gyro: [
+            Vec3::default(),
+            Vec3 {
+                x: 1.0,
+                y: 2.0,
+                z: 3.0,
+            },
+        ],
+        temperature: -40,
+        status: Status(7, true),
+        raw: [1, 0x8000, 0xFFFF],
+    }
+}
+
+#[test]
+fn derived_size() {
+    assert_eq!(Vec3::SIZE, 12);
+    assert_eq!(Status::SIZE, 2);
+    assert_eq!(Imu::SIZE, 4 + 8 + 12 + 24 + 2 + 2 + 6);
+}
+
+#[test]
+fn same_wire_format() {
+    let packet = Packet {
+        id: 9,
+        imu: imu(),
+        corrections: [Status(1, false), Status(2, true)],
+    };
+
+    let mut buf = [0u8; 128];
+    let mut plain = [0u8; 128];
+    let plain = to_slice(&(packet.id, &packet.imu, &packet.corrections), &mut plain).unwrap();
+    let output = to_slice(&packet, &mut buf).unwrap();
+    assert_eq!(output, plain);
+    assert_eq!(output.len(), 1 + Imu::SIZE + 4);
+
+    let out: Packet = from_bytes(output).unwrap();
+    assert_eq!(out, packet);
+
+    let out: Imu = from_bytes(&output[1..]).unwrap();
+    assert_eq!(out, packet.imu);
+
+    let mut direct = [0u8; Imu::SIZE];
+    packet.imu.write_le(&mut direct);
+    assert_eq!(&direct[..], &output[1..1 + Imu::SIZE]);
+    assert_eq!(Imu::read_le(&direct), Some(imu()));
+}
+
+#[test]
+fn errors() {
+    let packet = Packet {
+        id: 9,
+        imu: imu(),
+        corrections: [Status(1, false), Status(2, true)],
+    };
+    let mut buf = [0u8; 128];
+    let len = to_slice(&packet, &mut buf).unwrap().len();
+
+    assert_eq!(
+        from_bytes::<Packet>(&buf[..len - 1]),
+        Err(Error::DeserializeUnexpectedEnd)
+    );
+    assert_eq!(
+        to_slice(&packet, &mut [0u8; 32]),
+        Err(Error::SerializeBufferFull)
+    );
+
+    // `status.1` is a bool
+    buf[1 + Imu::SIZE - 7] = 2;
+    assert!(from_bytes::<Packet>(&buf[..len]).is_err());
+}
+
+/// Counts the calls to the flavor, to check that fixed-layout fields are written at once
+#[derive(Default)]
+struct Calls(usize);
+
+impl SerFlavor for Calls {
+    type Output = usize;
+
+    fn try_extend(&mut self, _data: &[u8]) -> Result<(), ()> {
+        self.0 += 1;
+        Ok(())
+    }
+
+    fn try_push(&mut self, _data: u8) -> Result<(), ()> {
+        self.0 += 1;
+        Ok(())
+    }
+
+    fn release(self) -> Result<usize, ()> {
+        Ok(self.0)
+    }
+}
+
+#[test]
+fn arrays() {
+    #[derive(Serialize)]
+    struct Corrections(#[serde(with = "postcard::fixed")] [Status; 2]);
+
+    let calls = serialize_with_flavor::<_, _, usize>(
+        &Corrections([Status(1, false), Status(2, true)]),
+        Calls::default(),
+    )
+    .unwrap();
+    assert_eq!(calls, 1);
+
+    // Other formats may hand over the bytes as a byte string or a sequence
+    let expected = [Status(1, false), Status(2, true)];
+    let bytes = BytesDeserializer::<value::Error>::new(&[1, 0, 2, 1]);
+    let out: [Status; 2] = postcard::fixed::deserialize(bytes).unwrap();
+    assert_eq!(out, expected);
+
+    let seq = SeqDeserializer::<_, value::Error>::new([1u8, 0, 2, 1].iter().copied());
+    let out: [Status; 2] = postcard::fixed::deserialize(seq).unwrap();
+    assert_eq!(out, expected);
+
+    let seq = SeqDeserializer::<_, value::Error>::new([1u8, 0, 2].iter().copied());
+    assert!(postcard::fixed::deserialize::<_, [Status; 2]>(seq).is_err());
+    let seq = SeqDeserializer::<_, value::Error>::new([1u8, 0, 2, 1, 0].iter().copied());
+    assert!(postcard::fixed::deserialize::<_, [Status; 2]>(seq).is_err());
+}
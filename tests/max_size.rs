@@ -0,0 +1,99 @@
+#![allow(unused_imports)]
+
+use core::marker::PhantomData;
+use core::ops::Deref;
+
+#[cfg(feature = "heapless")]
+use heapless::{String, Vec};
+
+#[cfg(feature = "heapless")]
+use postcard::{to_vec, to_vec_cobs};
+
+use postcard::max_size::{cobs_max_size, varint_max_size};
+use postcard::MaxSize;
+use serde::Serialize;
+
+#[test]
+fn primitives() {
+    assert_eq!(<()>::POSTCARD_MAX_SIZE, 0);
+    assert_eq!(bool::POSTCARD_MAX_SIZE, 1);
+    assert_eq!(u16::POSTCARD_MAX_SIZE, 2);
+    assert_eq!(f64::POSTCARD_MAX_SIZE, 8);
+    assert_eq!(char::POSTCARD_MAX_SIZE, 5);
+    assert_eq!(Option::<u32>::POSTCARD_MAX_SIZE, 5);
+    assert_eq!(<[u16; 8]>::POSTCARD_MAX_SIZE, 16);
+    assert_eq!(<(u8, u32, Option<i16>)>::POSTCARD_MAX_SIZE, 8);
+}
+
+#[test]
+fn varints_and_cobs() {
+    assert_eq!(varint_max_size(0), 1);
+    assert_eq!(varint_max_size(127), 1);
+    assert_eq!(varint_max_size(128), 2);
+    assert_eq!(cobs_max_size(0), 2);
+    assert_eq!(cobs_max_size(253), 255);
+    assert_eq!(cobs_max_size(254), 257);
+}
+
+#[cfg(feature = "derive")]
+#[derive(Serialize, MaxSize)]
+struct Telemetry {
+    seq: u32,
+    accel: [f32; 3],
+    fault: Option<u16>,
+}
+
+#[cfg(feature = "derive")]
+#[derive(Serialize, MaxSize)]
+struct Wrapper<T>(u8, T);
+
+#[cfg(feature = "derive")]
+#[allow(dead_code)]
+#[derive(Serialize, MaxSize)]
+enum Command {
+    Stop,
+    Move { axis: u8, steps: i32 },
+    Report(Telemetry),
+    Many(u64, u64),
+}
+
+#[cfg(feature = "derive")]
+#[test]
+fn derived() {
+    assert_eq!(Telemetry::POSTCARD_MAX_SIZE, 4 + 12 + 3);
+    assert_eq!(Wrapper::<u64>::POSTCARD_MAX_SIZE, 9);
+    assert_eq!(Command::POSTCARD_MAX_SIZE, 1 + 19);
+}
+
+#[cfg(all(feature = "derive", feature = "heapless"))]
+#[test]
+fn derived_buffers() {
+    const _: () = assert!(Command::POSTCARD_MAX_SIZE <= 32);
+
+    let cmd = Command::Report(Telemetry {
+        seq: 0xFFFF_FFFF,
+        accel: [1.0, -1.0, 0.5],
+        fault: Some(7),
+    });
+    let output = to_vec::<_, { Command::POSTCARD_MAX_SIZE }>(&cmd).unwrap();
+    assert_eq!(output.len(), Command::POSTCARD_MAX_SIZE);
+
+    let output = to_vec_cobs::<_, { cobs_max_size(Command::POSTCARD_MAX_SIZE) }>(&cmd).unwrap();
+    assert!(output.len() <= cobs_max_size(Command::POSTCARD_MAX_SIZE));
+}
+
+#[cfg(feature = "heapless")]
+#[test]
+fn heapless_containers() {
+    type Samples = Vec<u16, 200>;
+    assert_eq!(Samples::POSTCARD_MAX_SIZE, 2 + 400);
+
+    let mut input = Samples::new();
+    for i in 0..200 {
+        input.push(i).unwrap();
+    }
+    let output = to_vec::<_, { Samples::POSTCARD_MAX_SIZE }>(&input).unwrap();
+    assert_eq!(output.len(), Samples::POSTCARD_MAX_SIZE);
+
+    assert_eq!(String::<16>::POSTCARD_MAX_SIZE, 17);
+}